@@ -0,0 +1,869 @@
+// 流式热路径基准测试：不需要摄像头和网络，用录制的视频或合成帧按帧率离线驱动 VideoStreamer 的真实流水线
+// （处理阶段、编码线程池、按序发送），帧分发给模拟的 WebSocket 连接，输出各阶段延迟分位数（JSON）
+// 另外对比：行带并行 remap（undistort）与单次 remap（undistort_single），
+// 显示分辨率（960x540）下"校正后再缩放"与"校正缩放合并为一次 remap"，
+// 图像质量统计的多遍实现（quality_metrics_reference）与单遍 SIMD 实现（quality_metrics_fused）；
+// 以及 1 / 1k / 1M 个点的坐标映射：逐点 cv::perspectiveTransform、逐点 imageToGround、整批 perspectiveTransform、
+// imageToGroundBatch，以及启用稠密（cell 1）和稀疏（cell 8）图像→地面查找表后的 imageToGroundBatch
+// （point_mapping，单位为每点纳秒）；
+// ArUco 检测在合成的 1080p 场景上比较单级全分辨率检测与缩放比例 0.75 / 0.5 / 0.33 的两级检测的延迟、
+// 召回率（总体和按标记边长）与平均角点误差（aruco_detection）
+//
+// 用法：video_mapping_bench [--video=<文件>] [--frames=200] [--warmup=10] [--clients=4] [--fps=30]
+//                           [--resolutions=720p,1080p,4k] [--undistort-threads=N] [--output=<文件>]
+// JSON 写到标准输出（或 --output 指定的文件），进度信息写到标准错误
+
+#include "VideoStreamer.h"
+#include "CameraCalibrator.h"
+#include "ImageStats.h"
+#include "HomographyMapper.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/aruco.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct BenchOptions {
+    std::string videoPath;      // 为空时使用合成帧
+    int frames = 200;
+    int warmup = 10;            // 预热帧不计入统计（映射表初始化、缓冲池填充等）
+    int clients = 4;            // 模拟的连接数
+    int fps = 30;               // 送帧速率（模拟摄像头帧率）
+    int undistortThreads = 0;   // 并行去畸变线程数，0 表示使用 VideoStreamer 的默认值
+    std::vector<std::string> resolutions{"720p", "1080p", "4k"};
+    std::string outputPath;     // 为空时输出到标准输出
+};
+
+struct StageSamples {
+    std::vector<double> samples;  // 毫秒
+
+    void add(double ms) { samples.push_back(ms); }
+
+    // 最近秩法取分位数
+    double percentile(double p) const {
+        if (samples.empty()) return 0.0;
+        std::vector<double> sorted(samples);
+        std::sort(sorted.begin(), sorted.end());
+        size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.5);
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        return sorted[rank - 1];
+    }
+
+    double mean() const {
+        if (samples.empty()) return 0.0;
+        double sum = 0.0;
+        for (double s : samples) sum += s;
+        return sum / samples.size();
+    }
+};
+
+struct ResolutionResult {
+    std::string name;
+    cv::Size size;
+    std::map<std::string, StageSamples> stages;
+    double averageJpegBytes = 0.0;
+    int submittedFrames = 0;    // 计入统计的送入帧数
+    int deliveredFrames = 0;    // 计入统计的发送帧数（广播帧率控制会跳过部分帧）
+};
+
+using Clock = std::chrono::high_resolution_clock;
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// 原 evaluateImageQuality 的实现：CV_64F 拉普拉斯 + 两次 meanStdDev + 一次 mean，共四遍
+GrayImageStats referenceGrayImageStats(const cv::Mat& gray) {
+    GrayImageStats stats;
+    cv::Mat laplacian;
+    cv::Laplacian(gray, laplacian, CV_64F);
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(laplacian, mean, stddev);
+    stats.laplacianVariance = stddev.val[0] * stddev.val[0];
+    stats.mean = cv::mean(gray).val[0];
+    cv::meanStdDev(gray, mean, stddev);
+    stats.stddev = stddev.val[0];
+    return stats;
+}
+
+struct PointMappingResult {
+    size_t points = 0;
+    std::map<std::string, double> nsPerPoint;  // 各实现每个点的耗时（多次试验取中位数）
+};
+
+// 重复执行 run（每次处理 points 个点）直到总点数约为 2M，返回多次试验中每点耗时的中位数
+template <typename Fn>
+double measureNsPerPoint(size_t points, Fn run) {
+    const size_t repeats = std::max<size_t>(1, 2000000 / points);
+    const int trials = 5;
+    std::vector<double> perPoint;
+    for (int t = 0; t < trials; ++t) {
+        auto start = Clock::now();
+        for (size_t r = 0; r < repeats; ++r) {
+            run();
+        }
+        perPoint.push_back(elapsedMs(start) * 1e6 / (static_cast<double>(repeats) * points));
+    }
+    std::sort(perPoint.begin(), perPoint.end());
+    return perPoint[trials / 2];
+}
+
+// 批量映射的正确性检查：imageToGroundBatch / groundToImageBatch 与 cv::perspectiveTransform 逐点比较，
+// 覆盖各种点数（向量路径的整块与剩余的标量尾部）、原地调用（src == dst）以及 w 接近 0 的退化点
+bool verifyPointMapping() {
+    cv::Mat homography = (cv::Mat_<double>(3, 3) << 0.8, 0.05, -120.0, 0.02, 1.1, -40.0, 1e-4, 3e-4, 1.0);
+    HomographyMapper mapper;
+    mapper.setHomographyMatrix(homography);
+    mapper.setCalibrated(true);
+    cv::Mat inverse = mapper.getInverseHomographyMatrix();
+
+    cv::RNG rng(4321);
+    bool ok = true;
+    for (size_t points : {size_t(1), size_t(2), size_t(3), size_t(5), size_t(7), size_t(8), size_t(9), size_t(15),
+                          size_t(16), size_t(17), size_t(31), size_t(33), size_t(1000), size_t(1023)}) {
+        std::vector<cv::Point2f> src(points);
+        for (auto& p : src) {
+            p = cv::Point2f(rng.uniform(-200.f, 2200.f), rng.uniform(-200.f, 1300.f));
+        }
+        // 一个点放在 w = 0 的直线上（1e-4 x + 3e-4 y + 1 = 0），检查退化处理一致
+        if (points > 4) {
+            src[points / 2] = cv::Point2f(-10000.0f, 0.0f);
+        }
+
+        for (int direction = 0; direction < 2; ++direction) {
+            const cv::Mat& matrix = direction == 0 ? homography : inverse;
+            const char* name = direction == 0 ? "imageToGroundBatch" : "groundToImageBatch";
+            std::vector<cv::Point2f> expected;
+            cv::perspectiveTransform(src, expected, matrix);
+
+            std::vector<cv::Point2f> separate(points);
+            std::vector<cv::Point2f> inPlace(src);
+            bool mapped = direction == 0
+                ? mapper.imageToGroundBatch(src.data(), separate.data(), points) &&
+                  mapper.imageToGroundBatch(inPlace.data(), inPlace.data(), points)
+                : mapper.groundToImageBatch(src.data(), separate.data(), points) &&
+                  mapper.groundToImageBatch(inPlace.data(), inPlace.data(), points);
+            if (!mapped) {
+                std::cerr << "❌ [BENCH] " << name << " failed for " << points << " points" << std::endl;
+                ok = false;
+                continue;
+            }
+            for (size_t i = 0; i < points; ++i) {
+                const double tolerance = 1e-5 * std::max(1.0, cv::norm(expected[i]));
+                if (cv::norm(separate[i] - expected[i]) > tolerance || cv::norm(inPlace[i] - expected[i]) > tolerance) {
+                    std::cerr << "❌ [BENCH] " << name << " mismatch at point " << i << " of " << points << ": ("
+                              << separate[i].x << ", " << separate[i].y << ") / in place (" << inPlace[i].x << ", "
+                              << inPlace[i].y << "), expected (" << expected[i].x << ", " << expected[i].y << ")"
+                              << std::endl;
+                    ok = false;
+                    break;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+std::vector<PointMappingResult> runPointMapping() {
+    // 典型的俯视标定：轻微透视
+    cv::Mat homography = (cv::Mat_<double>(3, 3) << 0.8, 0.05, -120.0, 0.02, 1.1, -40.0, 1e-4, 3e-4, 1.0);
+    HomographyMapper mapper;
+    mapper.setHomographyMatrix(homography);
+    mapper.setCalibrated(true);
+    // 查找表只在内存中生成，不写缓存文件
+    HomographyMapper denseLutMapper;
+    denseLutMapper.enableGroundLookupTable(cv::Size(1920, 1080), 1);
+    denseLutMapper.setHomographyMatrix(homography);
+    denseLutMapper.setCalibrated(true);
+    HomographyMapper coarseLutMapper;
+    coarseLutMapper.enableGroundLookupTable(cv::Size(1920, 1080), 8);
+    coarseLutMapper.setHomographyMatrix(homography);
+    coarseLutMapper.setCalibrated(true);
+
+    std::vector<PointMappingResult> results;
+    cv::RNG rng(12345);
+    for (size_t points : {size_t(1), size_t(1000), size_t(1000000)}) {
+        std::vector<cv::Point2f> src(points), dst(points);
+        for (auto& p : src) {
+            p = cv::Point2f(rng.uniform(0.f, 1920.f), rng.uniform(0.f, 1080.f));
+        }
+
+        PointMappingResult result;
+        result.points = points;
+        // 原实现：每个点分配两个 vector 并调用 cv::perspectiveTransform
+        result.nsPerPoint["per_point_perspective_transform"] = measureNsPerPoint(points, [&] {
+            for (size_t i = 0; i < points; ++i) {
+                std::vector<cv::Point2f> in = {src[i]};
+                std::vector<cv::Point2f> out;
+                cv::perspectiveTransform(in, out, homography);
+                dst[i] = out[0];
+            }
+        });
+        result.nsPerPoint["per_point_image_to_ground"] = measureNsPerPoint(points, [&] {
+            for (size_t i = 0; i < points; ++i) {
+                dst[i] = mapper.imageToGround(src[i]);
+            }
+        });
+        result.nsPerPoint["batch_perspective_transform"] = measureNsPerPoint(points, [&] {
+            cv::perspectiveTransform(src, dst, homography);
+        });
+        result.nsPerPoint["batch_image_to_ground"] = measureNsPerPoint(points, [&] {
+            mapper.imageToGroundBatch(src.data(), dst.data(), points);
+        });
+        result.nsPerPoint["batch_ground_lut_dense"] = measureNsPerPoint(points, [&] {
+            denseLutMapper.imageToGroundBatch(src.data(), dst.data(), points);
+        });
+        result.nsPerPoint["batch_ground_lut_cell8"] = measureNsPerPoint(points, [&] {
+            coarseLutMapper.imageToGroundBatch(src.data(), dst.data(), points);
+        });
+        results.push_back(result);
+    }
+    return results;
+}
+
+struct ArUcoScaleResult {
+    double scale = 1.0;
+    StageSamples latency;
+    int expected = 0;                      // 所有帧中应检测到的标记总数
+    int found = 0;                         // ID 正确且角点在标记边长 1/4 以内的检测数
+    double cornerErrorSum = 0.0;           // 找到的标记四个角点的平均误差（像素）之和
+    std::map<int, std::pair<int, int>> bySize;  // 标记边长 -> (找到数, 应检测数)
+};
+
+struct SyntheticMarker {
+    int id;
+    int side;                              // 透视变换前的边长（像素）
+    std::vector<cv::Point2f> corners;      // 真实角点，顺序与 detectMarkers 相同（左上、右上、右下、左下）
+};
+
+// 1080p 合成场景：灰色纹理背景上不同边长的 DICT_4X4_50 标记（带白色静区），整体轻微透视后加模糊和噪声
+cv::Mat makeArUcoScene(const cv::Size& size, int seed, std::vector<SyntheticMarker>& markers) {
+    const std::vector<int> sides = {24, 32, 48, 64, 96, 128, 192};
+    cv::Ptr<cv::aruco::Dictionary> dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    cv::Mat flat(size, CV_8UC3, cv::Scalar(110, 120, 115));
+    cv::RNG rng(seed);
+    for (int i = 0; i < 200; ++i) {
+        cv::Point center(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        cv::circle(flat, center, rng.uniform(5, 60), cv::Scalar::all(rng.uniform(60, 190)), -1);
+    }
+
+    // 每种边长 3 个，按列排布，列宽取该边长加静区
+    markers.clear();
+    int id = 0;
+    int x = 40;
+    for (int side : sides) {
+        const int quiet = std::max(4, side / 4);
+        int y = 40;
+        for (int k = 0; k < 3 && x + side + 2 * quiet < size.width; ++k) {
+            if (y + side + 2 * quiet > size.height) {
+                break;
+            }
+            cv::rectangle(flat, cv::Rect(x, y, side + 2 * quiet, side + 2 * quiet), cv::Scalar::all(255), -1);
+            cv::Mat marker;
+            cv::aruco::drawMarker(dictionary, id, side, marker, 1);
+            cv::Mat target = flat(cv::Rect(x + quiet, y + quiet, side, side));
+            cv::cvtColor(marker, target, cv::COLOR_GRAY2BGR);
+            // 像素中心为整数坐标，标记外边缘位于第一个像素中心左上方半个像素
+            const float left = x + quiet - 0.5f;
+            const float top = y + quiet - 0.5f;
+            markers.push_back({id, side, {cv::Point2f(left, top), cv::Point2f(left + side, top),
+                                          cv::Point2f(left + side, top + side), cv::Point2f(left, top + side)}});
+            id++;
+            y += side + 2 * quiet + 40;
+        }
+        x += side + 2 * quiet + 40;
+    }
+
+    // 轻微透视（模拟斜向下看的相机），真实角点随之变换
+    const float w = static_cast<float>(size.width);
+    const float h = static_cast<float>(size.height);
+    std::vector<cv::Point2f> from = {{0, 0}, {w, 0}, {w, h}, {0, h}};
+    std::vector<cv::Point2f> to = {{0.03f * w, 0.02f * h}, {0.98f * w, 0}, {w, h}, {0, 0.97f * h}};
+    cv::Mat homography = cv::getPerspectiveTransform(from, to);
+    cv::Mat frame;
+    cv::warpPerspective(flat, frame, homography, size, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(110, 120, 115));
+    for (auto& marker : markers) {
+        cv::perspectiveTransform(marker.corners, marker.corners, homography);
+    }
+
+    cv::GaussianBlur(frame, frame, cv::Size(3, 3), 0.8);
+    cv::Mat noisy, noise(size, CV_16SC3);
+    frame.convertTo(noisy, CV_16S);
+    cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(4));
+    noisy += noise;
+    noisy.convertTo(frame, CV_8U);
+    return frame;
+}
+
+// ArUco 检测：单级全分辨率与不同缩放比例的两级检测，比较延迟、召回率和角点误差
+std::vector<ArUcoScaleResult> runArUcoDetection(const BenchOptions& options) {
+    const cv::Size size(1920, 1080);
+    const int sceneCount = 4;  // 多个噪声和背景不同的场景轮流使用
+    std::vector<cv::Mat> scenes;
+    std::vector<std::vector<SyntheticMarker>> truth(sceneCount);
+    for (int i = 0; i < sceneCount; ++i) {
+        scenes.push_back(makeArUcoScene(size, 1000 + i, truth[i]));
+    }
+
+    std::vector<ArUcoScaleResult> results;
+    HomographyMapper mapper;
+    std::vector<int> ids;
+    std::vector<std::vector<cv::Point2f>> corners;
+    for (double scale : {1.0, 0.75, 0.5, 0.33}) {
+        mapper.setArUcoDetectionScale(scale);
+        ArUcoScaleResult result;
+        result.scale = mapper.getArUcoDetectionScale();
+        for (int i = 0; i < options.warmup + options.frames; ++i) {
+            const int scene = i % sceneCount;
+            auto start = Clock::now();
+            mapper.detectArUcoMarkers(scenes[scene], ids, corners);
+            double ms = elapsedMs(start);
+            if (i < options.warmup) {
+                continue;
+            }
+            result.latency.add(ms);
+
+            for (const auto& marker : truth[scene]) {
+                result.expected++;
+                result.bySize[marker.side].second++;
+                for (size_t d = 0; d < ids.size(); ++d) {
+                    if (ids[d] != marker.id || corners[d].size() != 4) {
+                        continue;
+                    }
+                    double error = 0.0;
+                    for (int c = 0; c < 4; ++c) {
+                        error += cv::norm(corners[d][c] - marker.corners[c]) / 4.0;
+                    }
+                    if (error < marker.side / 4.0) {
+                        result.found++;
+                        result.bySize[marker.side].first++;
+                        result.cornerErrorSum += error;
+                    }
+                    break;
+                }
+            }
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+bool parseResolution(const std::string& name, cv::Size& size) {
+    if (name == "720p") { size = cv::Size(1280, 720); return true; }
+    if (name == "1080p") { size = cv::Size(1920, 1080); return true; }
+    if (name == "4k" || name == "2160p") { size = cv::Size(3840, 2160); return true; }
+    int w = 0, h = 0;
+    if (std::sscanf(name.c_str(), "%dx%d", &w, &h) == 2 && w > 0 && h > 0) {
+        size = cv::Size(w, h);
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::string> splitList(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const std::string& prefix) { return arg.substr(prefix.size()); };
+        if (arg.rfind("--video=", 0) == 0) {
+            options.videoPath = value("--video=");
+        } else if (arg.rfind("--frames=", 0) == 0) {
+            options.frames = std::max(1, std::atoi(value("--frames=").c_str()));
+        } else if (arg.rfind("--warmup=", 0) == 0) {
+            options.warmup = std::max(0, std::atoi(value("--warmup=").c_str()));
+        } else if (arg.rfind("--clients=", 0) == 0) {
+            options.clients = std::max(1, std::atoi(value("--clients=").c_str()));
+        } else if (arg.rfind("--fps=", 0) == 0) {
+            options.fps = std::max(1, std::atoi(value("--fps=").c_str()));
+        } else if (arg.rfind("--resolutions=", 0) == 0) {
+            options.resolutions = splitList(value("--resolutions="));
+        } else if (arg.rfind("--undistort-threads=", 0) == 0) {
+            options.undistortThreads = std::max(1, std::atoi(value("--undistort-threads=").c_str()));
+        } else if (arg.rfind("--output=", 0) == 0) {
+            options.outputPath = value("--output=");
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// 合成帧：棋盘格背景、渐变和移动的色块，JPEG大小接近真实画面
+cv::Mat makeSyntheticFrame(const cv::Size& size, int index) {
+    cv::Mat frame(size, CV_8UC3);
+    int square = std::max(8, size.width / 24);
+    for (int y = 0; y < size.height; ++y) {
+        cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < size.width; ++x) {
+            bool dark = ((x / square) + (y / square)) % 2 == 0;
+            uchar base = dark ? 40 : 200;
+            row[x] = cv::Vec3b(base, static_cast<uchar>(base / 2 + (x * 127) / size.width),
+                               static_cast<uchar>(base / 2 + (y * 127) / size.height));
+        }
+    }
+    int radius = size.height / 8;
+    cv::Point center((index * 17) % size.width, size.height / 2);
+    cv::circle(frame, center, radius, cv::Scalar(30, 180, 250), -1);
+    cv::putText(frame, "frame " + std::to_string(index), cv::Point(20, size.height - 40),
+                cv::FONT_HERSHEY_SIMPLEX, size.height / 540.0, cv::Scalar(255, 255, 255), 2);
+
+    // 少量噪声，避免大面积平坦区域让编码器过于轻松
+    cv::Mat noise(size, CV_8UC3);
+    cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(12));
+    frame += noise;
+    return frame;
+}
+
+// 写入与分辨率匹配的合成相机内参（轻微桶形畸变），供 VideoStreamer 加载
+bool writeSyntheticCalibration(const std::string& path, const cv::Size& size) {
+    try {
+        double focal = 0.8 * size.width;
+        cv::Mat cameraMatrix = (cv::Mat_<double>(3, 3) << focal, 0, size.width / 2.0,
+                                                          0, focal, size.height / 2.0,
+                                                          0, 0, 1);
+        cv::Mat distCoeffs = (cv::Mat_<double>(1, 5) << -0.25, 0.08, 0.0005, -0.0005, 0.0);
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (!fs.isOpened()) {
+            return false;
+        }
+        fs << "camera_matrix" << cameraMatrix;
+        fs << "dist_coeffs" << distCoeffs;
+        fs << "board_width" << 9;
+        fs << "board_height" << 6;
+        fs << "square_size" << 0.025f;
+        fs << "avg_reprojection_error" << 0.0;
+        fs.release();
+        return true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error writing calibration file: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+// 四个标定点，使叠加绘制包含标定点和网格线
+void setupCalibrationOverlay(VideoStreamer& streamer, const cv::Size& size) {
+    streamer.clearCalibrationPoints();
+    const float w = static_cast<float>(size.width);
+    const float h = static_cast<float>(size.height);
+    streamer.addCalibrationPoint(cv::Point2f(0.2f * w, 0.3f * h), cv::Point2f(0, 0));
+    streamer.addCalibrationPoint(cv::Point2f(0.8f * w, 0.3f * h), cv::Point2f(200, 0));
+    streamer.addCalibrationPoint(cv::Point2f(0.9f * w, 0.9f * h), cv::Point2f(200, 150));
+    streamer.addCalibrationPoint(cv::Point2f(0.1f * w, 0.9f * h), cv::Point2f(0, 150));
+    streamer.computeHomography();
+}
+
+// 模拟的 WebSocket 连接：与 Crow 的连接一样按值接收消息体并放入写队列（只保留最后一条），不做网络发送
+// 由发送线程在 conn_mutex_ 下调用，流水线停止后才读取计数
+class BenchConnection : public crow::websocket::connection {
+public:
+    void send_binary(std::string msg) override {
+        binaryMessages++;
+        binaryBytes += msg.size();
+        writeQueue_ = std::move(msg);
+    }
+    void send_text(std::string msg) override {
+        textMessages++;
+        writeQueue_ = std::move(msg);
+    }
+    void send_ping(std::string) override {}
+    void send_pong(std::string) override {}
+    void close(std::string const&, uint16_t) override {}
+    std::string get_remote_ip() override { return "127.0.0.1"; }
+    std::string get_subprotocol() const override { return ""; }
+
+    uint64_t binaryMessages = 0;
+    uint64_t binaryBytes = 0;
+    uint64_t textMessages = 0;
+
+private:
+    std::string writeQueue_;
+};
+
+// 发送线程回调中收集的每帧数据（预热结束前采集的帧不计入）
+struct DeliverySamples {
+    std::mutex mutex;
+    std::chrono::steady_clock::time_point measureStart = std::chrono::steady_clock::time_point::max();
+    std::chrono::steady_clock::time_point lastDelivery;
+    StageSamples encode;
+    StageSamples send;
+    StageSamples captureToSend;
+    double totalBytes = 0.0;
+    int frames = 0;
+};
+
+bool runResolution(const BenchOptions& options, VideoStreamer& streamer, CameraCalibrator& calibrator,
+                   const std::string& name, const cv::Size& size, ResolutionResult& result) {
+    result.name = name;
+    result.size = size;
+
+    std::string calibrationPath = "video_mapping_bench_calibration.xml";
+    if (!writeSyntheticCalibration(calibrationPath, size) || !streamer.loadCameraCalibrationData(calibrationPath) ||
+        !calibrator.loadCalibrationData(calibrationPath)) {
+        std::cerr << "Failed to prepare synthetic calibration for " << name << std::endl;
+        return false;
+    }
+    std::remove(calibrationPath.c_str());
+    setupCalibrationOverlay(streamer, size);
+
+    cv::VideoCapture video;
+    if (!options.videoPath.empty() && !video.open(options.videoPath)) {
+        std::cerr << "Failed to open video file: " << options.videoPath << std::endl;
+        return false;
+    }
+
+    // 编码阶段的耗时、发送阶段的分发耗时和端到端延迟由发送线程逐帧回报
+    DeliverySamples delivery;
+    streamer.setDeliveryObserver([&delivery](const EncodedFrame& frame, double sendMs) {
+        std::lock_guard<std::mutex> lock(delivery.mutex);
+        delivery.lastDelivery = std::chrono::steady_clock::now();
+        if (frame.captureTime < delivery.measureStart) {
+            return;
+        }
+        delivery.encode.add(frame.encodeMs);
+        delivery.send.add(sendMs);
+        delivery.captureToSend.add(
+            std::chrono::duration<double, std::milli>(delivery.lastDelivery - frame.captureTime).count());
+        delivery.totalBytes += frame.payload.size();
+        delivery.frames++;
+    });
+    // 叠加绘制的耗时由处理阶段逐帧回报；离线驱动时在 submitOfflineFrame() 内同步调用，不需要加锁
+    double overlayMs = -1.0;
+    streamer.setBroadcastObserver([&overlayMs](double, double frameOverlayMs) {
+        overlayMs = frameOverlayMs;
+    });
+    if (!streamer.startOffline(size.width, size.height, options.fps)) {
+        streamer.setDeliveryObserver(nullptr);
+        streamer.setBroadcastObserver(nullptr);
+        return false;
+    }
+    std::vector<std::unique_ptr<BenchConnection>> connections;
+    for (int c = 0; c < options.clients; ++c) {
+        connections.push_back(std::make_unique<BenchConnection>());
+        streamer.handleWebSocket(crow::request(), connections.back().get());
+    }
+
+    const cv::Size displaySize(960, 540);
+    const auto frameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / options.fps));
+    auto nextFrame = std::chrono::steady_clock::now();
+    cv::Mat displayFrame;
+    bool ok = true;
+
+    for (int i = 0; i < options.warmup + options.frames && ok; ++i) {
+        bool record = i >= options.warmup;
+        if (i == options.warmup) {
+            std::lock_guard<std::mutex> lock(delivery.mutex);
+            delivery.measureStart = std::chrono::steady_clock::now();
+        }
+
+        // 按摄像头帧率送帧；处理跟不上时不等待
+        std::this_thread::sleep_until(nextFrame);
+        nextFrame = std::max(nextFrame + frameInterval, std::chrono::steady_clock::now());
+        auto start = Clock::now();
+
+        // 取帧：录制视频循环播放并缩放到目标分辨率，否则生成合成帧
+        cv::Mat frame;
+        if (video.isOpened()) {
+            cv::Mat decoded;
+            if (!video.read(decoded) || decoded.empty()) {
+                video.set(cv::CAP_PROP_POS_FRAMES, 0);
+                if (!video.read(decoded) || decoded.empty()) {
+                    std::cerr << "Failed to read frames from " << options.videoPath << std::endl;
+                    ok = false;
+                    break;
+                }
+            }
+            if (decoded.size() != size) {
+                cv::resize(decoded, frame, size, 0, 0, cv::INTER_AREA);
+            } else {
+                frame = decoded;
+            }
+            if (record) result.stages["capture"].add(elapsedMs(start));
+        } else {
+            frame = makeSyntheticFrame(size, i);
+        }
+
+        // 对照项在送入流水线之前测量（送入后帧会被原地绘制）
+        // 畸变校正：行带并行 remap 与同一映射表单次 remap（基准测试自己的校正器不使用线程池）
+        start = Clock::now();
+        cv::Mat corrected = streamer.undistortImage(frame);
+        double undistortMs = elapsedMs(start);
+        if (record) result.stages["undistort"].add(undistortMs);
+        start = Clock::now();
+        cv::Mat correctedSingle = calibrator.undistortImage(frame);
+        if (record) result.stages["undistort_single"].add(elapsedMs(start));
+        if (corrected.empty()) {
+            corrected = frame;
+        }
+
+        // 显示分辨率：校正后再缩放（两遍）与合并映射表（一遍）
+        start = Clock::now();
+        cv::resize(corrected, displayFrame, displaySize, 0, 0, cv::INTER_LINEAR);
+        if (record) result.stages["undistort_then_resize_display"].add(undistortMs + elapsedMs(start));
+        start = Clock::now();
+        displayFrame = calibrator.undistortImage(frame, displaySize);
+        if (record) result.stages["undistort_fused_display"].add(elapsedMs(start));
+
+        // 图像质量统计：多遍实现与单遍融合实现，结果应一致
+        cv::Mat gray;
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        start = Clock::now();
+        GrayImageStats referenceStats = referenceGrayImageStats(gray);
+        if (record) result.stages["quality_metrics_reference"].add(elapsedMs(start));
+        start = Clock::now();
+        GrayImageStats fusedStats = computeGrayImageStats(gray);
+        if (record) result.stages["quality_metrics_fused"].add(elapsedMs(start));
+        auto differs = [](double value, double reference) {
+            return std::abs(value - reference) > 1e-6 * std::max(1.0, std::abs(reference));
+        };
+        if (differs(fusedStats.mean, referenceStats.mean) || differs(fusedStats.stddev, referenceStats.stddev) ||
+            differs(fusedStats.laplacianVariance, referenceStats.laplacianVariance)) {
+            std::cerr << "Fused quality metrics differ from reference at " << name << " frame " << i
+                      << ": mean " << fusedStats.mean << " / " << referenceStats.mean
+                      << ", stddev " << fusedStats.stddev << " / " << referenceStats.stddev
+                      << ", laplacian variance " << fusedStats.laplacianVariance << " / "
+                      << referenceStats.laplacianVariance << std::endl;
+            ok = false;
+            break;
+        }
+
+        // 处理阶段：与处理线程相同的校正、状态与标定点叠加绘制、准备广播并交给编码线程池
+        // 其中叠加绘制单独记为 overlay（广播帧率控制跳过的帧不绘制，没有 overlay 样本）
+        overlayMs = -1.0;
+        start = Clock::now();
+        if (!streamer.submitOfflineFrame(std::move(frame))) {
+            std::cerr << "Pipeline rejected frame " << i << " at " << name << std::endl;
+            ok = false;
+            break;
+        }
+        if (record) {
+            result.stages["process"].add(elapsedMs(start));
+            if (overlayMs >= 0.0) {
+                result.stages["overlay"].add(overlayMs);
+            }
+            result.submittedFrames++;
+        }
+    }
+
+    // 等待编码和发送排空：超过重排等待时间没有新的发送即认为结束
+    auto drainDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (ok && std::chrono::steady_clock::now() < drainDeadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::lock_guard<std::mutex> lock(delivery.mutex);
+        if (std::chrono::steady_clock::now() - delivery.lastDelivery > std::chrono::milliseconds(300)) {
+            break;
+        }
+    }
+    streamer.stop();  // 停止线程并移除模拟连接
+    streamer.setDeliveryObserver(nullptr);
+    streamer.setBroadcastObserver(nullptr);
+
+    result.stages["encode"] = delivery.encode;
+    result.stages["send"] = delivery.send;
+    result.stages["capture_to_send"] = delivery.captureToSend;
+    result.deliveredFrames = delivery.frames;
+    result.averageJpegBytes = delivery.frames > 0 ? delivery.totalBytes / delivery.frames : 0.0;
+    if (ok && delivery.frames == 0) {
+        std::cerr << "No frames were delivered to the simulated connections at " << name << std::endl;
+        ok = false;
+    }
+    for (const auto& connection : connections) {
+        if (ok && connection->binaryMessages == 0) {
+            std::cerr << "A simulated connection received no frames at " << name << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// JSON 字符串转义（引号、反斜杠和控制字符）
+std::string jsonEscape(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char ch : value) {
+        switch (ch) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(ch));
+                    escaped += buf;
+                } else {
+                    escaped += ch;
+                }
+        }
+    }
+    return escaped;
+}
+
+std::string toJson(const BenchOptions& options, int undistortThreads, const std::vector<ResolutionResult>& results,
+                   const std::vector<PointMappingResult>& pointMapping,
+                   const std::vector<ArUcoScaleResult>& arucoDetection) {
+    std::ostringstream json;
+    json.setf(std::ios::fixed);
+    json.precision(3);
+    json << "{\n";
+    json << "  \"benchmark\": \"video_mapping_bench\",\n";
+    json << "  \"source\": \"" << (options.videoPath.empty() ? "synthetic" : jsonEscape(options.videoPath)) << "\",\n";
+    json << "  \"frames\": " << options.frames << ",\n";
+    json << "  \"warmup\": " << options.warmup << ",\n";
+    json << "  \"clients\": " << options.clients << ",\n";
+    json << "  \"fps\": " << options.fps << ",\n";
+    json << "  \"opencv_version\": \"" << CV_VERSION << "\",\n";
+    json << "  \"threads\": " << cv::getNumThreads() << ",\n";
+    json << "  \"undistort_threads\": " << undistortThreads << ",\n";
+    json << "  \"results\": [";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const ResolutionResult& result = results[r];
+        json << (r == 0 ? "\n" : ",\n");
+        json << "    {\n";
+        json << "      \"resolution\": \"" << result.name << "\",\n";
+        json << "      \"width\": " << result.size.width << ",\n";
+        json << "      \"height\": " << result.size.height << ",\n";
+        json << "      \"avg_jpeg_bytes\": " << result.averageJpegBytes << ",\n";
+        json << "      \"submitted_frames\": " << result.submittedFrames << ",\n";
+        json << "      \"delivered_frames\": " << result.deliveredFrames << ",\n";
+        json << "      \"stages\": {";
+        bool first = true;
+        for (const auto& stage : result.stages) {
+            json << (first ? "\n" : ",\n");
+            first = false;
+            json << "        \"" << stage.first << "\": {"
+                 << "\"p50_ms\": " << stage.second.percentile(50) << ", "
+                 << "\"p95_ms\": " << stage.second.percentile(95) << ", "
+                 << "\"p99_ms\": " << stage.second.percentile(99) << ", "
+                 << "\"mean_ms\": " << stage.second.mean() << ", "
+                 << "\"samples\": " << stage.second.samples.size() << "}";
+        }
+        json << "\n      }\n";
+        json << "    }";
+    }
+    json << "\n  ],\n";
+    json << "  \"point_mapping\": [";
+    for (size_t r = 0; r < pointMapping.size(); ++r) {
+        json << (r == 0 ? "\n" : ",\n");
+        json << "    {\"points\": " << pointMapping[r].points;
+        for (const auto& entry : pointMapping[r].nsPerPoint) {
+            json << ", \"" << entry.first << "_ns\": " << entry.second;
+        }
+        json << "}";
+    }
+    json << "\n  ],\n";
+    json << "  \"aruco_detection\": [";
+    for (size_t r = 0; r < arucoDetection.size(); ++r) {
+        const ArUcoScaleResult& result = arucoDetection[r];
+        json << (r == 0 ? "\n" : ",\n");
+        json << "    {\"scale\": " << result.scale
+             << ", \"p50_ms\": " << result.latency.percentile(50)
+             << ", \"p95_ms\": " << result.latency.percentile(95)
+             << ", \"mean_ms\": " << result.latency.mean()
+             << ", \"recall\": " << (result.expected > 0 ? static_cast<double>(result.found) / result.expected : 0.0)
+             << ", \"mean_corner_error_px\": " << (result.found > 0 ? result.cornerErrorSum / result.found : 0.0)
+             << ", \"recall_by_side_px\": {";
+        bool first = true;
+        for (const auto& entry : result.bySize) {
+            json << (first ? "" : ", ") << "\"" << entry.first << "\": "
+                 << (entry.second.second > 0 ? static_cast<double>(entry.second.first) / entry.second.second : 0.0);
+            first = false;
+        }
+        json << "}}";
+    }
+    json << "\n  ]\n";
+    json << "}\n";
+    return json.str();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: video_mapping_bench [--video=<file>] [--frames=N] [--warmup=N] [--clients=N] [--fps=N]"
+                     " [--resolutions=720p,1080p,4k|WxH] [--undistort-threads=N] [--output=<file>]" << std::endl;
+        return 1;
+    }
+
+    // VideoStreamer 的日志输出到标准输出，基准测试期间重定向到标准错误，保证标准输出只有JSON
+    std::streambuf* stdoutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+    VideoStreamer streamer;
+    CameraCalibrator calibrator;
+    if (options.undistortThreads > 0) {
+        streamer.setUndistortThreadCount(options.undistortThreads);
+    }
+    // 整帧去畸变并在标定模式下绘制标定点，覆盖处理阶段最重的路径
+    streamer.setCameraCorrectionEnabled(true);
+    if (!streamer.isCalibrationMode()) {
+        streamer.toggleCalibrationMode();
+    }
+    std::vector<ResolutionResult> results;
+    for (const auto& name : options.resolutions) {
+        cv::Size size;
+        if (!parseResolution(name, size)) {
+            std::cerr << "Unknown resolution: " << name << std::endl;
+            continue;
+        }
+        std::cerr << "⏱️ [BENCH] " << name << " (" << size.width << "x" << size.height << "), "
+                  << options.frames << " frames..." << std::endl;
+        ResolutionResult result;
+        if (runResolution(options, streamer, calibrator, name, size, result)) {
+            results.push_back(std::move(result));
+        }
+    }
+
+    std::cerr << "⏱️ [BENCH] Verifying batch point mapping against cv::perspectiveTransform..." << std::endl;
+    const bool pointMappingCorrect = verifyPointMapping();
+    
+    std::cerr << "⏱️ [BENCH] Point mapping (1, 1k, 1M points)..." << std::endl;
+    std::vector<PointMappingResult> pointMapping = runPointMapping();
+
+    std::cerr << "⏱️ [BENCH] ArUco detection (1080p, scales 1 / 0.75 / 0.5 / 0.33)..." << std::endl;
+    std::vector<ArUcoScaleResult> arucoDetection = runArUcoDetection(options);
+
+    std::cout.rdbuf(stdoutBuffer);
+
+    std::string json = toJson(options, streamer.getUndistortThreadCount(), results, pointMapping, arucoDetection);
+    if (options.outputPath.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(options.outputPath);
+        if (!out) {
+            std::cerr << "Failed to write " << options.outputPath << std::endl;
+            return 1;
+        }
+        out << json;
+        std::cerr << "✅ [BENCH] Results written to " << options.outputPath << std::endl;
+    }
+    if (!pointMappingCorrect) {
+        std::cerr << "❌ [BENCH] Batch point mapping does not match cv::perspectiveTransform" << std::endl;
+        return 1;
+    }
+    return results.empty() ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+#ifndef ARUCO_DETECTION_WORKER_H
+#define ARUCO_DETECTION_WORKER_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Frame.h"
+
+// 一次检测的结果：角点为检测所用帧（imageSize）的像素坐标
+struct ArUcoDetectionResult {
+    uint64_t sequence = 0;                            // 检测所用帧的采集序号
+    std::chrono::steady_clock::time_point timestamp;  // 检测所用帧的采集时间
+    cv::Size imageSize;
+    std::vector<int> markerIds;
+    std::vector<std::vector<cv::Point2f>> markerCorners;
+    double detectMs = 0.0;
+};
+
+using ArUcoDetectionResultPtr = std::shared_ptr<const ArUcoDetectionResult>;
+
+// ArUco 后台检测：检测在独立线程中进行，广播路径只绘制最近一次的结果，不再等待检测
+// - 只保留最新提交的一帧，检测线程忙时到达的旧帧直接被替换，检测的总是能拿到的最新画面
+// - 检测频率可以单独限制（maxRate），与采集和推流帧率无关；0 表示检测完一帧立即处理下一帧
+// - 检测线程在第一次 submit() 时启动；reset() 丢弃待检测帧和已有结果，正在进行的检测结果也不再发布
+class ArUcoDetectionWorker {
+public:
+    using Detector = std::function<bool(const cv::Mat&, std::vector<int>&, std::vector<std::vector<cv::Point2f>>&)>;
+
+    struct Stats {
+        uint64_t detections = 0;       // 完成的检测次数
+        uint64_t replacedFrames = 0;   // 未检测就被更新的帧替换掉的帧数
+        double maxRate = 0.0;
+        double lastDetectMs = 0.0;
+        double averageDetectMs = 0.0;
+    };
+
+    explicit ArUcoDetectionWorker(Detector detector);
+    ~ArUcoDetectionWorker();
+
+    ArUcoDetectionWorker(const ArUcoDetectionWorker&) = delete;
+    ArUcoDetectionWorker& operator=(const ArUcoDetectionWorker&) = delete;
+
+    void submit(FramePtr frame);               // 不阻塞
+    ArUcoDetectionResultPtr latest() const;    // 最近一次检测结果，尚无结果时为空
+    void reset();
+
+    void setMaxRate(double detectionsPerSecond);
+    Stats getStats() const;
+
+private:
+    void workerLoop();
+
+    Detector detector_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    bool stopping_ = false;
+    FramePtr pending_;
+    ArUcoDetectionResultPtr latest_;
+    uint64_t generation_ = 0;                  // reset() 时递增，丢弃进行中的检测结果
+    std::chrono::steady_clock::time_point nextDetection_;  // 限速时下一次检测的最早开始时间
+    Stats stats_;
+    double totalDetectMs_ = 0.0;
+};
+
+#endif // ARUCO_DETECTION_WORKER_H
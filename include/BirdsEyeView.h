@@ -0,0 +1,50 @@
+#ifndef BIRDS_EYE_VIEW_H
+#define BIRDS_EYE_VIEW_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+// 地面俯视（鸟瞰）视图：按单应性矩阵把原始帧变换为公制比例的俯视图
+// - 输出像素 (u, v) 的中心对应地面坐标 (x + (u + 0.5) * mmPerPixel, y + (v + 0.5) * mmPerPixel)，
+//   其中 (x, y) 为 groundBounds 的左上角，地面 y 轴与图像一样向下
+// - 映射表把"地面 -> 无畸变像素"的逆单应性变换和"无畸变像素 -> 原始像素"的镜头畸变合并，
+//   直接从未去畸变的原始帧一次 remap 得到俯视图，不需要先整帧去畸变
+// - 映射表只在视图参数、单应性矩阵、相机标定或输入分辨率变化时重建；地平线以上（无法投影到地面）的像素输出黑色
+class BirdsEyeView {
+public:
+    struct Config {
+        cv::Rect2f groundBounds;   // 地面范围，单位与标定点的地面坐标相同（通常为毫米）
+        double mmPerPixel = 0.0;   // 每个输出像素对应的地面长度
+    };
+
+    // 检查参数并按需重建映射表，返回映射表是否可用；cameraMatrix/distCoeffs 为空表示单应性矩阵直接作用在原始像素上
+    bool prepare(const Config& config, const cv::Matx33d& groundToImage, const cv::Size& inputSize,
+                 const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, uint64_t calibrationVersion);
+    // 用当前映射表变换一帧（输入尺寸须与 prepare() 时一致），输出使用池化缓冲区
+    bool warp(const cv::Mat& frame, cv::Mat& output) const;
+    void clear();
+
+    bool isReady() const { return !map1_.empty(); }
+    const Config& config() const { return config_; }
+    cv::Size outputSize() const { return outputSize_; }
+    double lastBuildMs() const { return lastBuildMs_; }
+
+    static const int kMaxOutputSide = 4096;  // 输出边长上限，防止比例设置错误时生成巨大的映射表
+
+private:
+    bool buildMaps(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs);
+
+    // 最近一次 prepare() 的参数（prepared_ 为真时有效）
+    bool prepared_ = false;
+    Config config_;
+    cv::Matx33d groundToImage_;
+    cv::Size inputSize_;
+    bool distorted_ = false;
+    uint64_t calibrationVersion_ = 0;
+
+    cv::Size outputSize_;
+    cv::Mat map1_, map2_;   // 定点格式（CV_16SC2 + CV_16UC1），remap 比浮点映射表快
+    double lastBuildMs_ = 0.0;
+};
+
+#endif // BIRDS_EYE_VIEW_H
@@ -0,0 +1,76 @@
+#ifndef CALIBRATION_IMAGE_WRITER_H
+#define CALIBRATION_IMAGE_WRITER_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 一张待保存的标定图像：角点和说明文字在写入线程中绘制到副本上
+struct CalibrationImageJob {
+    std::string path;
+    cv::Mat image;                        // 只读引用，写入线程复制后再绘制
+    cv::Size boardSize;
+    std::vector<cv::Point2f> corners;
+    std::string caption;
+};
+
+// 标定图像的后台写入器：绘制、JPEG编码和写盘都在独立线程中完成，调用方永远不会因存储而阻塞
+// - 有界队列，满时按策略丢弃（丢弃新图像或最旧的图像），enqueue() 返回 false 通知调用方发生了丢弃
+// - 目录用 std::filesystem 直接创建，不再调用 shell
+// - 写入线程在第一次 enqueue() 时启动；析构时写完队列中剩余的图像
+class CalibrationImageWriter {
+public:
+    enum class OverflowPolicy {
+        DropNewest,  // 队列满时丢弃新提交的图像（默认，已排队的图像先写完）
+        DropOldest   // 队列满时丢弃最旧的待写图像
+    };
+
+    struct Stats {
+        size_t queueDepth = 0;
+        size_t capacity = 0;
+        uint64_t written = 0;
+        uint64_t failed = 0;
+        uint64_t dropped = 0;
+        double lastWriteMs = 0.0;     // 最近一次写入耗时（绘制 + 编码 + 写盘）
+        double averageWriteMs = 0.0;
+        double maxWriteMs = 0.0;
+    };
+
+    explicit CalibrationImageWriter(size_t capacity = 8, OverflowPolicy policy = OverflowPolicy::DropNewest);
+    ~CalibrationImageWriter();
+
+    CalibrationImageWriter(const CalibrationImageWriter&) = delete;
+    CalibrationImageWriter& operator=(const CalibrationImageWriter&) = delete;
+
+    // 不阻塞；发生丢弃时返回 false，droppedPath 非空时写入被丢弃图像的路径（可能是新图像，也可能是最旧的待写图像）
+    bool enqueue(CalibrationImageJob job, std::string* droppedPath = nullptr);
+    bool waitUntilIdle(std::chrono::milliseconds timeout);  // 等待队列写空（用于退出前或测试）
+
+    void setOverflowPolicy(OverflowPolicy policy);
+    Stats getStats() const;
+
+private:
+    void writerLoop();
+    bool writeJob(const CalibrationImageJob& job);
+
+    const size_t capacity_;
+    OverflowPolicy policy_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;   // 有新任务或需要退出
+    std::condition_variable idle_;   // 队列已写空
+    std::deque<CalibrationImageJob> queue_;
+    std::thread thread_;
+    bool stopping_ = false;
+    bool writing_ = false;           // 写入线程正在处理一个任务
+    std::string createdDirectory_;   // 已确认存在的目录，避免每张图像都访问文件系统
+    Stats stats_;
+    double totalWriteMs_ = 0.0;
+};
+
+#endif // CALIBRATION_IMAGE_WRITER_H
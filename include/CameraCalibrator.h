@@ -4,10 +4,18 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <string>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "ThreadPool.h"
+#include "CalibrationImageWriter.h"
 
 class CameraCalibrator {
 public:
     CameraCalibrator();
+    ~CameraCalibrator();  // 等待并行检测中仍在后台运行的回退策略结束
     
     // 设置棋盘格参数
     void setChessboardSize(int width, int height);
@@ -16,6 +24,8 @@ public:
     // 图像保存控制
     void setSaveCalibrationImages(bool save) { saveCalibrationImages = save; }
     bool getSaveCalibrationImages() const { return saveCalibrationImages; }
+    CalibrationImageWriter::Stats getImageWriterStats() const { return imageWriter.getStats(); } // 后台写入队列深度与写入耗时
+    void setImageWriterOverflowPolicy(CalibrationImageWriter::OverflowPolicy policy) { imageWriter.setOverflowPolicy(policy); }
     
     // 高斯模糊核设置
     void setBlurKernelSize(int size) { blurKernelSize = size; }
@@ -43,10 +53,23 @@ public:
     
     // 图像去畸变
     cv::Mat undistortImage(const cv::Mat& image);
+    // 去畸变并缩放到 outputSize：映射表把缩放合并进去，一次 remap 完成，不再单独 resize
+    cv::Mat undistortImage(const cv::Mat& image, const cv::Size& outputSize);
+    // 只保留输出尺寸在 outputSizes 中的映射表，其余释放（全分辨率映射表每张约占 12 字节/像素）
+    void retainUndistortMaps(const std::vector<cv::Size>& outputSizes);
+    // 点去畸变：只校正坐标（cv::undistortPoints，输出为与 undistortImage 相同的无畸变像素坐标），不处理整帧
+    cv::Point2f undistortPoint(const cv::Point2f& point);
+    cv::Point2f distortPoint(const cv::Point2f& point);  // 逆变换：无畸变像素坐标 -> 原始图像坐标（用于在未校正的画面上绘制）
+    // 标定矩阵快照及标定版本（标定或加载后递增），供自行合并畸变映射的模块判断是否需要重建；未标定时返回 false
+    bool getCalibrationSnapshot(cv::Mat& cameraMatrixOut, cv::Mat& distCoeffsOut, uint64_t& version) const;
+    
+    // 并行去畸变：输出按水平行带拆分到线程池中执行（线程数包括调用线程，1 表示单次 remap）
+    void setUndistortThreadCount(int count);
+    int getUndistortThreadCount() const;
     
     // 获取标定结果
-    cv::Mat getCameraMatrix() const { return cameraMatrix; }
-    cv::Mat getDistCoeffs() const { return distCoeffs; }
+    cv::Mat getCameraMatrix() const;   // 与 setCalibrationMatrices() 同一把锁，可在任意线程调用
+    cv::Mat getDistCoeffs() const;
     double getCalibrationError() const { return totalError; }
     bool isCalibrated() const { return calibrated; }
     size_t getImageCount() const;
@@ -60,8 +83,27 @@ public:
     cv::Size getBoardSize() const { return boardSize; }
     float getSquareSize() const { return squareSize; }
     
-    // 公共棋盘格检测方法，供前端和后端共用
-    bool detectChessboard(const cv::Mat& image, std::vector<cv::Point2f>& corners, bool isForCalibration = false);
+    // 棋盘格检测策略：Coarse 为由粗到精检测，其余为全分辨率的回退策略
+    enum class ChessboardStrategy { None = -1, Coarse, Relaxed, Enhanced, Strict, Sharpened, Contrast };
+    static constexpr int kChessboardStrategyCount = 6;
+    static const char* chessboardStrategyName(ChessboardStrategy strategy);
+    
+    // 公共棋盘格检测方法，供前端和后端共用；strategy 非空时返回成功的策略（失败为 None）
+    bool detectChessboard(const cv::Mat& image, std::vector<cv::Point2f>& corners, bool isForCalibration = false,
+                          ChessboardStrategy* strategy = nullptr);
+    
+    // 并行回退检测：每个回退策略一个线程同时运行，第一个成功的策略立即返回，其余策略在后台跑完并计入统计
+    void setParallelDetectionEnabled(bool enabled);
+    bool isParallelDetectionEnabled() const;
+    
+    // 各策略在本相机上的尝试次数、成功次数和平均耗时；回退策略按成功次数自适应排序
+    struct ChessboardStrategyStats {
+        std::string name;
+        uint64_t attempts;
+        uint64_t wins;
+        double averageMs;
+    };
+    std::vector<ChessboardStrategyStats> getChessboardStrategyStats() const;
     
     // 图片质量评估和预处理
     struct ImageQualityMetrics {
@@ -78,6 +120,7 @@ public:
     ImageQualityMetrics evaluateImageQuality(const cv::Mat& image, const std::vector<cv::Point2f>& corners);
     bool shouldAcceptImage(const ImageQualityMetrics& metrics);
     cv::Mat preprocessImage(const cv::Mat& image);  // 图像预处理
+    cv::Mat preprocessGray(const cv::Mat& image);   // 灰度预处理：全部增强在单通道上完成，输出 CV_8UC1
     void filterCalibrationImages();  // 过滤已有图片
 
 private:
@@ -93,18 +136,64 @@ private:
     cv::Mat cameraMatrix;    // 相机内参矩阵
     cv::Mat distCoeffs;      // 畸变系数
     double totalError;       // 重投影误差
-    bool calibrated;         // 是否已完成标定
+    std::atomic<bool> calibrated; // 是否已完成标定（其他线程通过 isCalibrated() 读取）
 
     // 图像尺寸
     cv::Size imageSize;      // 图像尺寸
     
+    // 去畸变映射表缓存：按（输入尺寸, 输出尺寸, 标定版本）区分，可同时保存多种分辨率
+    // 映射表生成后只读，以 shared_ptr 交给调用方，remap 期间不持有锁，缓存被清除也不影响正在使用的映射表
+    struct UndistortMaps {
+        cv::Size inputSize;
+        cv::Size outputSize;
+        uint64_t calibrationVersion = 0;
+        cv::Mat map1, map2;
+    };
+    std::vector<std::shared_ptr<const UndistortMaps>> undistortMaps;
+    mutable std::mutex undistortMapMutex; // 保护映射表缓存、标定矩阵的替换和线程池
+    std::shared_ptr<ThreadPool> undistortPool;  // 为空时单线程 remap
+    uint64_t calibrationVersion = 0;   // 标定或加载标定数据后递增，旧版本的映射表随之失效
+    // 按标定快照（矩阵和版本号）取得映射表，未命中时在锁外生成后放入缓存
+    std::shared_ptr<const UndistortMaps> getUndistortMaps(const cv::Size& inputSize, const cv::Size& outputSize,
+                                                          const cv::Mat& K, const cv::Mat& D, uint64_t version);
+    std::shared_ptr<const UndistortMaps> findUndistortMapsLocked(const cv::Size& inputSize, const cv::Size& outputSize, uint64_t version); // 调用方持有 undistortMapMutex
+    void setCalibrationMatrices(const cv::Mat& newCameraMatrix, const cv::Mat& newDistCoeffs); // 替换标定矩阵并使映射表失效
+    bool getCalibrationSnapshot(cv::Mat& cameraMatrixOut, cv::Mat& distCoeffsOut) const; // 在锁内取得标定矩阵的引用
+    
+    // 由粗到精的棋盘格检测：先在缩小的图像上检测，找到后只在全分辨率的角点邻域内做亚像素细化
+    static constexpr int kCoarseDetectionWidth = 640;  // 粗检测图像宽度，不超过此宽度的图像直接全分辨率检测
+    bool detectChessboardCoarse(const cv::Mat& grayImage, std::vector<cv::Point2f>& corners, bool& boardLikely);
+    void refineCornersInRoi(const cv::Mat& grayImage, std::vector<cv::Point2f>& corners, int searchRadius);
+    bool runChessboardStrategy(ChessboardStrategy strategy, const cv::Mat& grayImage, const cv::Size& board,
+                               std::vector<cv::Point2f>& corners);
+    std::vector<ChessboardStrategy> getFallbackStrategyOrder(bool includeSlow) const;
+    void recordChessboardStrategy(ChessboardStrategy strategy, bool found, double elapsedMs);
+    
+    // 策略统计与并行检测
+    struct StrategyCounters {
+        uint64_t attempts = 0;
+        uint64_t wins = 0;
+        double totalMs = 0.0;
+    };
+    StrategyCounters strategyCounters[kChessboardStrategyCount];
+    bool parallelDetection = false;              // 为假时按顺序执行回退策略
+    int runningStrategies = 0;                   // 并行检测中尚未结束的策略线程数
+    std::condition_variable strategiesFinished;  // runningStrategies 归零
+    mutable std::mutex detectionMutex;           // 保护策略统计和并行检测状态
+    
+    // preprocessGray 跨调用复用的中间缓冲区和 CLAHE 对象
+    std::mutex preprocessMutex;
+    cv::Mat preprocessScratch;
+    cv::Mat preprocessDenoised;
+    cv::Ptr<cv::CLAHE> preprocessClahe;
+    
     // 辅助函数
     void calculateObjectPoints();
     void initializeExistingImageCount();  // 初始化已有图片数量
-    bool isMatrixEqual(const cv::Mat& mat1, const cv::Mat& mat2);  // 矩阵比较辅助函数
 
     // 图像保存控制
     bool saveCalibrationImages;
+    CalibrationImageWriter imageWriter;  // 标定图像的后台写入器（首次保存时启动写入线程）
     int nextImageNumber;     // 下一个图片的编号
     
     // 高斯模糊核大小
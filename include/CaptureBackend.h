@@ -0,0 +1,120 @@
+#ifndef CAPTURE_BACKEND_H
+#define CAPTURE_BACKEND_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 采集数据的像素格式
+enum class CapturePixelFormat {
+    BGR,    // 已解码的 BGR 图像
+    MJPEG,  // 一行原始 JPEG 数据（1xN, CV_8UC1）
+    YUYV    // YUV 4:2:2 打包格式（HxW, CV_8UC2）
+};
+
+enum class CaptureBackendType {
+    OpenCV,     // cv::VideoCapture（默认）
+    V4L2Mmap,   // 直接使用 V4L2 mmap 缓冲区环，零拷贝
+    FakeFile    // 从文件读取的模拟设备，用于没有摄像头的机器
+};
+
+struct CaptureConfig {
+    std::string device;                              // 设备路径（/dev/videoN）或模拟设备的文件/目录
+    int width = 1920;
+    int height = 1080;
+    int fps = 30;
+    CapturePixelFormat format = CapturePixelFormat::MJPEG;  // 期望的格式，实际格式以 pixelFormat() 为准
+    int bufferCount = 4;                             // 驱动缓冲区数量
+};
+
+// 采集后端接口
+// read() 返回的 Mat 是驱动缓冲区的零拷贝视图：在最后一个引用释放之前缓冲区不会归还给驱动，
+// 因此持有帧的时间越长，可用于采集的缓冲区越少。所有视图都释放后才会真正解除映射。
+class CaptureBackend {
+public:
+    virtual ~CaptureBackend() = default;
+
+    virtual bool open(const CaptureConfig& config) = 0;
+    virtual void close() = 0;
+    virtual bool isOpened() const = 0;
+    virtual bool read(cv::Mat& frame) = 0;
+    virtual cv::Size frameSize() const = 0;
+    virtual CapturePixelFormat pixelFormat() const = 0;
+    virtual int bufferCount() const = 0;      // 实际分配的缓冲区数量
+    virtual int buffersInUse() const = 0;     // 当前被视图持有、尚未归还的缓冲区数量
+    virtual const char* name() const = 0;
+
+    static std::unique_ptr<CaptureBackend> create(CaptureBackendType type);
+};
+
+// 缓冲区环：视图释放时通过 requeue() 归还缓冲区
+class CaptureBufferRing : public std::enable_shared_from_this<CaptureBufferRing> {
+public:
+    virtual ~CaptureBufferRing() = default;
+    virtual void requeue(int index) = 0;
+
+    // 把缓冲区 index 包装为零拷贝 Mat 视图；视图及其所有副本释放后自动调用 requeue(index)
+    cv::Mat wrap(int index, void* data, int rows, int cols, int type, size_t step);
+    int outstanding() const { return outstanding_; }
+
+private:
+    friend class CaptureBufferAllocator;
+    std::atomic<int> outstanding_{0};
+};
+
+// V4L2 mmap 采集：VIDIOC_REQBUFS 申请驱动缓冲区并 mmap，出队的缓冲区直接作为 Mat 视图交给流水线
+class V4L2MmapCapture : public CaptureBackend {
+public:
+    V4L2MmapCapture() = default;
+    ~V4L2MmapCapture() override;
+
+    bool open(const CaptureConfig& config) override;
+    void close() override;
+    bool isOpened() const override;
+    bool read(cv::Mat& frame) override;
+    cv::Size frameSize() const override { return size_; }
+    CapturePixelFormat pixelFormat() const override { return format_; }
+    int bufferCount() const override;
+    int buffersInUse() const override;
+    const char* name() const override { return "V4L2 mmap"; }
+
+private:
+    class Ring;
+    std::shared_ptr<Ring> ring_;
+    cv::Size size_;
+    CapturePixelFormat format_ = CapturePixelFormat::MJPEG;
+    size_t bytesPerLine_ = 0;
+};
+
+// 文件模拟设备：循环读取 JPEG 文件（单个文件或目录）或原始 YUYV 文件（.yuv/.yuyv，按配置的宽高切帧），
+// 按配置的帧率输出，缓冲区环语义与 V4L2 后端一致
+class FakeFileCapture : public CaptureBackend {
+public:
+    FakeFileCapture() = default;
+    ~FakeFileCapture() override;
+
+    bool open(const CaptureConfig& config) override;
+    void close() override;
+    bool isOpened() const override;
+    bool read(cv::Mat& frame) override;
+    cv::Size frameSize() const override { return size_; }
+    CapturePixelFormat pixelFormat() const override { return format_; }
+    int bufferCount() const override;
+    int buffersInUse() const override;
+    const char* name() const override { return "fake file"; }
+
+private:
+    class Ring;
+    std::shared_ptr<Ring> ring_;
+    std::vector<std::vector<uchar>> sourceFrames_;  // 预先读入内存的帧数据
+    size_t nextSource_ = 0;
+    cv::Size size_;
+    CapturePixelFormat format_ = CapturePixelFormat::MJPEG;
+    std::chrono::steady_clock::duration frameInterval_{};
+    std::chrono::steady_clock::time_point nextFrameTime_;
+};
+
+#endif // CAPTURE_BACKEND_H
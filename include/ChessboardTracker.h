@@ -0,0 +1,35 @@
+#ifndef CHESSBOARD_TRACKER_H
+#define CHESSBOARD_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// 棋盘格角点的帧间跟踪：用金字塔光流（calcOpticalFlowPyrLK）跟随上一次检测到的角点，
+// 跟踪结果经亚像素细化并通过网格几何校验后使用；跟踪失败或连续跟踪过久（见 trackedFrames()）时由调用方重新做完整检测
+// - 上一帧的图像金字塔会被保留，每帧只为新帧构建一次金字塔
+// - 非线程安全，应只在一个线程（处理线程）中使用
+class ChessboardTracker {
+public:
+    ChessboardTracker() = default;
+
+    // 用一次完整检测的结果（重新）初始化跟踪；gray 为检测所用的灰度图
+    void reset(const cv::Mat& gray, const cv::Size& boardSize, const std::vector<cv::Point2f>& corners);
+    void clear();
+
+    // 把角点跟踪到新帧；成功时输出角点并返回 true，失败时停止跟踪并返回 false
+    bool update(const cv::Mat& gray, std::vector<cv::Point2f>& corners);
+
+    bool isTracking() const { return !corners_.empty(); }
+    const cv::Size& boardSize() const { return boardSize_; }
+    int trackedFrames() const { return trackedFrames_; }  // 自上次完整检测以来连续跟踪的帧数
+
+private:
+    bool isValidGrid(const std::vector<cv::Point2f>& corners, const cv::Size& imageSize) const;
+
+    cv::Size boardSize_;
+    std::vector<cv::Point2f> corners_;
+    std::vector<cv::Mat> previousPyramid_;
+    int trackedFrames_ = 0;
+};
+
+#endif // CHESSBOARD_TRACKER_H
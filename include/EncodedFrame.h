@@ -0,0 +1,25 @@
+#ifndef ENCODED_FRAME_H
+#define ENCODED_FRAME_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+// 已编码的广播帧：每帧（每个质量档位）只编码一次，之后以只读方式在所有连接间共享
+struct EncodedFrame {
+    std::string payload;     // WebSocket 二进制消息体（JPEG 数据）
+    int quality = 0;         // JPEG 质量档位
+    int width = 0;           // 编码时的图像宽度
+    int height = 0;          // 编码时的图像高度
+    uint64_t sequence = 0;   // 广播帧序号
+    int tier = -1;           // 自适应质量档位，-1 表示发给所有连接
+    bool birdsEye = false;   // 鸟瞰视图的帧，只发给选择鸟瞰视图的连接（其余帧只发给选择原始画面的连接）
+    bool tileUpdate = false; // 分块增量更新（TILE 消息），依赖之前发送的内容，不能乱序发送
+    std::chrono::steady_clock::time_point captureTime;  // 所用采集帧的采集时间
+    double encodeMs = 0.0;   // 编码耗时（直通帧为 0）
+};
+
+using EncodedFramePtr = std::shared_ptr<const EncodedFrame>;
+
+#endif // ENCODED_FRAME_H
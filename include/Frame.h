@@ -0,0 +1,53 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "EncodedFrame.h"
+
+// 采集处理后的一帧：发布后只读，在采集线程与所有消费者之间共享，不再复制像素数据
+struct Frame {
+    cv::Mat image;                                   // 处理后的图像（发布后不可修改）；直通模式下在需要时才解码
+    cv::Mat display;                                 // 显示分辨率的校正帧（与校正合并为一次 remap 生成），没有显示消费者时为空
+    cv::Mat birdsEye;                                // 地面俯视视图，没有连接选择鸟瞰视图时为空
+    EncodedFramePtr compressed;                      // MJPEG直通模式下摄像头输出的原始JPEG数据
+    uint64_t sequence = 0;                           // 采集帧序号
+    std::chrono::steady_clock::time_point timestamp; // 采集时间
+};
+
+using FramePtr = std::shared_ptr<const Frame>;
+
+// 最新帧槽位：写者原子地发布新帧，读者原子地取得快照
+// - 读者拿到的是不可变快照，持有期间写者可以继续发布新帧，互不阻塞
+// - 旧帧在最后一个读者释放后自动回收
+class FrameSlot {
+public:
+    void publish(FramePtr frame) {
+        std::atomic_store_explicit(&frame_, std::move(frame), std::memory_order_release);
+        version_.fetch_add(1, std::memory_order_release);
+    }
+
+    FramePtr load() const {
+        return std::atomic_load_explicit(&frame_, std::memory_order_acquire);
+    }
+
+    // 仅当槽位仍持有 expected 时替换为 desired（用于直通帧解码后回填），返回是否替换
+    bool replace(FramePtr expected, FramePtr desired) {
+        return std::atomic_compare_exchange_strong_explicit(&frame_, &expected, std::move(desired),
+                                                            std::memory_order_acq_rel, std::memory_order_acquire);
+    }
+
+    // 每次发布递增，可用于判断是否有新帧
+    uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+    void reset() { publish(FramePtr()); }
+
+private:
+    FramePtr frame_;
+    std::atomic<uint64_t> version_{0};
+};
+
+#endif // FRAME_H
@@ -0,0 +1,61 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// 帧缓冲池：回收 cv::Mat 的像素缓冲区，避免每帧都向堆申请/释放数 MB 内存
+// - 作为自定义 cv::MatAllocator 使用：由 acquire() 创建或设置了 allocator 的 Mat，
+//   释放时缓冲区回到池中，下次申请相同尺寸和类型（即相同字节数）时直接复用
+// - 每种尺寸最多保留 maxBuffersPerSize 个空闲缓冲区，超出部分直接释放
+// - 池对象在进程内常驻（instance() 永不析构），保证晚于所有引用它的 Mat 释放
+class FramePool : public cv::MatAllocator {
+public:
+    struct Stats {
+        uint64_t allocations = 0;  // 向堆申请新缓冲区的次数（累计）
+        uint64_t reuses = 0;       // 从池中复用缓冲区的次数（累计）
+        size_t pooledBuffers = 0;  // 当前池中空闲缓冲区数量
+        size_t pooledBytes = 0;    // 当前池中空闲缓冲区总字节数
+    };
+
+    static FramePool& instance();
+
+    // 从池中取得指定尺寸和类型的 Mat；之后对它的 create()/写入只要尺寸类型不变就不会重新分配
+    cv::Mat acquire(cv::Size size, int type);
+    cv::Mat acquire(int rows, int cols, int type) { return acquire(cv::Size(cols, rows), type); }
+
+    // 让一个空的 Mat 在下一次 create() 时从池中分配（例如作为 VideoCapture::read 的输出）
+    void attach(cv::Mat& mat);
+
+    void setMaxBuffersPerSize(size_t count);
+    Stats getStats() const;
+    void clear();  // 释放池中所有空闲缓冲区
+
+    // cv::MatAllocator 接口
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+private:
+    FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    uchar* takeBuffer(size_t bytes) const;
+    void returnBuffer(uchar* buffer, size_t bytes) const;
+
+    mutable std::mutex mutex_;
+    mutable std::unordered_map<size_t, std::vector<uchar*>> freeBuffers_;  // 按缓冲区字节数（尺寸×类型）分组
+    mutable size_t pooledBuffers_ = 0;
+    mutable size_t pooledBytes_ = 0;
+    size_t maxBuffersPerSize_ = 8;
+    mutable std::atomic<uint64_t> allocations_{0};
+    mutable std::atomic<uint64_t> reuses_{0};
+};
+
+#endif // FRAME_POOL_H
@@ -0,0 +1,145 @@
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// 流水线阶段之间的有界无锁环形队列
+// - 基于每个槽位的序号实现（Vyukov 有界队列），push/pop 均不加锁
+// - 队列满时丢弃最旧的元素（drop-oldest），保证消费者拿到的总是较新的帧
+// - 流水线中按单生产者/单消费者使用；由于生产者在丢弃最旧元素时也会出队，
+//   实现本身按多生产者/多消费者安全的方式编写
+template <typename T>
+class BoundedFrameQueue {
+public:
+    explicit BoundedFrameQueue(size_t capacity = 4) {
+        // 容量向上取整为2的幂，便于用掩码取槽位
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        capacity_ = capacity < 2 ? 2 : capacity;
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedFrameQueue(const BoundedFrameQueue&) = delete;
+    BoundedFrameQueue& operator=(const BoundedFrameQueue&) = delete;
+
+    // 入队；队列满时丢弃最旧的元素。返回 false 表示本次入队发生了丢弃
+    bool push(T item) {
+        return push(std::move(item), [](T&) {});
+    }
+
+    // 同上，每个被丢弃的元素先交给 onDrop（例如通知下游不要再等待它）
+    template <typename OnDrop>
+    bool push(T item, OnDrop&& onDrop) {
+        bool droppedAny = false;
+        while (size() >= capacity_ || !tryPush(item)) {
+            T oldest;
+            if (tryPop(oldest)) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                droppedAny = true;
+                onDrop(oldest);
+            }
+        }
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+        return !droppedAny;
+    }
+
+    // 非阻塞出队
+    bool tryPop(T& item) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // 队列为空
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->data = T();  // 尽早释放槽位持有的帧数据
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 等待出队，最多等待 timeout；队列为空时先让出CPU，再短暂休眠
+    template <typename Rep, typename Period>
+    bool popWait(T& item, std::chrono::duration<Rep, Period> timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        int spins = 0;
+        while (!tryPop(item)) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            if (++spins < 16) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        return true;
+    }
+
+    // 当前队列深度（近似值）
+    size_t size() const {
+        size_t enq = enqueuePos_.load(std::memory_order_acquire);
+        size_t deq = dequeuePos_.load(std::memory_order_acquire);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+    uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t pushedCount() const { return pushed_.load(std::memory_order_relaxed); }
+
+    // 丢弃队列中所有元素（不计入丢帧统计）
+    void clear() {
+        T item;
+        while (tryPop(item)) {}
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T data;
+    };
+
+    bool tryPush(T& item) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // 队列已满
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    size_t capacity_ = 0;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) std::atomic<size_t> dequeuePos_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> pushed_{0};
+};
+
+#endif // FRAME_QUEUE_H
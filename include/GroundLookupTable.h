@@ -0,0 +1,83 @@
+#ifndef GROUND_LOOKUP_TABLE_H
+#define GROUND_LOOKUP_TABLE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 图像→地面坐标查找表：在间距为 cellSize 像素的网格节点上预先计算单应性映射，查询时双线性插值
+// - cellSize = 1 时每个整数像素一个节点（稠密表），整数像素处的结果与直接计算完全一致
+// - 查询只做一次查表和插值，不含除法和分支，适合批量处理和编译器自动向量化
+// - 可以保存为带文件头的二进制文件，load() 用 mmap 只读映射，文件头中的矩阵和尺寸与当前一致才使用
+class GroundLookupTable {
+public:
+    ~GroundLookupTable();
+
+    GroundLookupTable(const GroundLookupTable&) = delete;
+    GroundLookupTable& operator=(const GroundLookupTable&) = delete;
+
+    // 用单应性矩阵在内存中生成查找表，覆盖 [0, width-1] x [0, height-1]
+    static std::shared_ptr<const GroundLookupTable> build(const cv::Matx33d& homography, const cv::Size& imageSize,
+                                                          int cellSize);
+    // 映射缓存文件；文件不存在、损坏或与参数不一致时返回 nullptr
+    static std::shared_ptr<const GroundLookupTable> load(const std::string& filename, const cv::Matx33d& homography,
+                                                         const cv::Size& imageSize, int cellSize);
+    // 先写临时文件再重命名，其他进程看到的缓存文件总是完整的
+    bool save(const std::string& filename) const;
+
+    // 点在表的覆盖范围内时写入 groundPoint 并返回 true
+    bool lookup(const cv::Point2f& imagePoint, cv::Point2f& groundPoint) const {
+        if (!contains(imagePoint)) {
+            return false;
+        }
+        groundPoint = interpolate(imagePoint);
+        return true;
+    }
+    // 批量查询：范围内的点写入 dst，返回第一个超出范围的点的下标（全部命中时返回 count）
+    size_t lookupBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const;
+
+    bool contains(const cv::Point2f& p) const {
+        return p.x >= 0.0f && p.y >= 0.0f && p.x <= maxX_ && p.y <= maxY_;
+    }
+
+    cv::Size imageSize() const { return imageSize_; }
+    int cellSize() const { return cellSize_; }
+    bool isMapped() const { return mapping_ != nullptr; }  // 数据来自内存映射的文件
+    size_t byteSize() const { return static_cast<size_t>(gridCols_) * gridRows_ * sizeof(cv::Point2f); }
+
+private:
+    GroundLookupTable(const cv::Matx33d& homography, const cv::Size& imageSize, int cellSize);
+
+    // 调用前需保证 contains(p)
+    cv::Point2f interpolate(const cv::Point2f& p) const {
+        const float fx = p.x * inverseCell_;
+        const float fy = p.y * inverseCell_;
+        const int ix = std::min(static_cast<int>(fx), gridCols_ - 2);
+        const int iy = std::min(static_cast<int>(fy), gridRows_ - 2);
+        const float tx = fx - ix;
+        const float ty = fy - iy;
+        const cv::Point2f* top = nodes_ + static_cast<size_t>(iy) * gridCols_ + ix;
+        const cv::Point2f* bottom = top + gridCols_;
+        const cv::Point2f upper = top[0] + (top[1] - top[0]) * tx;
+        const cv::Point2f lower = bottom[0] + (bottom[1] - bottom[0]) * tx;
+        return upper + (lower - upper) * ty;
+    }
+
+    cv::Matx33d homography_;
+    cv::Size imageSize_;
+    int cellSize_;
+    int gridCols_;
+    int gridRows_;
+    float inverseCell_;
+    float maxX_;
+    float maxY_;
+
+    const cv::Point2f* nodes_ = nullptr;   // 指向 ownedNodes_ 或映射区域中的节点数据
+    std::vector<cv::Point2f> ownedNodes_;
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+};
+
+#endif // GROUND_LOOKUP_TABLE_H
@@ -3,11 +3,13 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/aruco.hpp>
+#include "GroundLookupTable.h"
 #include <vector>
 #include <string>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 
 class HomographyMapper {
 public:
@@ -34,7 +36,9 @@ public:
                            std::vector<std::vector<cv::Point2f>>& markerCorners);
     void drawDetectedMarkers(cv::Mat& frame, const std::vector<int>& markerIds, 
                            const std::vector<std::vector<cv::Point2f>>& markerCorners);
-    bool calibrateFromArUcoMarkers(const cv::Mat& frame, const std::map<int, cv::Point2f>& markerGroundCoordinates);
+    // cameraMatrix/distCoeffs 非空时，标记中心先经 cv::undistortPoints 校正到无畸变像素坐标再参与标定（帧本身未去畸变）
+    bool calibrateFromArUcoMarkers(const cv::Mat& frame, const std::map<int, cv::Point2f>& markerGroundCoordinates,
+                                   const cv::Mat& cameraMatrix = cv::Mat(), const cv::Mat& distCoeffs = cv::Mat());
     void setMarkerGroundCoordinates(int markerId, const cv::Point2f& groundCoord);
     std::map<int, cv::Point2f> getMarkerGroundCoordinates() const;
     bool saveMarkerGroundCoordinates(const std::string& filename) const;
@@ -47,6 +51,10 @@ public:
     void getDetectionParameters(int& adaptiveThreshWinSizeMin, int& adaptiveThreshWinSizeMax, 
                                int& adaptiveThreshWinSizeStep, double& adaptiveThreshConstant) const;
     int getCornerRefinementMethod() const;
+    // 两级检测：scale < 1 时先在缩小 scale 倍的图像上找候选标记，再在全分辨率图像上每个角点的邻域内做亚像素细化
+    // （无论角点优化方法如何设置都会细化，以消除缩小带来的定位误差）；scale = 1 为原来的单级全分辨率检测
+    void setArUcoDetectionScale(double scale);
+    double getArUcoDetectionScale() const;
     
     // 坐标系设置和转换相关方法
     void setOrigin(const cv::Point2f& imagePoint);
@@ -58,6 +66,24 @@ public:
     cv::Point2f imageToGroundWithOrigin(const cv::Point2f& imagePoint) const;
     cv::Point2f groundToImageWithOrigin(const cv::Point2f& groundPoint) const;
     
+    // 批量坐标变换：直接用缓存的 3x3 矩阵计算（向量化，不分配内存），结果与 cv::perspectiveTransform 一致
+    // （启用图像→地面查找表时，imageToGround 方向对表内的点返回查表插值结果）
+    // src 与 dst 各有 count 个点，可以指向同一块内存（原地变换）
+    // 未标定时返回 false：imageToGround/groundToImage 版本原样复制输入，WithOrigin 版本输出 (0, 0)，与单点版本一致
+    bool imageToGroundBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const;
+    bool groundToImageBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const;
+    bool imageToGroundWithOriginBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const;
+    bool groundToImageWithOriginBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const;
+    void convertToPolarBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const;
+    void convertToCartesianBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const;
+    
+    // 图像→地面查找表：启用后在单应性矩阵变化时（computeHomography/setHomographyMatrix/loadHomography）重建，
+    // imageToGround 系列函数对表覆盖范围内的点直接查表插值，范围外的点仍按矩阵计算
+    // cachePath 非空时查找表保存为可内存映射的文件，重启后矩阵未变则直接映射，不再重新计算
+    void enableGroundLookupTable(const cv::Size& imageSize, int cellSize = 1, const std::string& cachePath = "");
+    void disableGroundLookupTable();
+    std::shared_ptr<const GroundLookupTable> getGroundLookupTable() const;
+    
     // 绘制网格线和坐标系
     void drawGridLines(cv::Mat& frame, int gridSize = 50, int numLines = 10) const;
     void drawCoordinateSystem(cv::Mat& frame) const;
@@ -67,11 +93,27 @@ private:
     std::vector<std::pair<cv::Point2f, cv::Point2f>> calibrationPoints_; // 图像点和地面点对
     cv::Mat homographyMatrix_;      // 单应性矩阵（从图像到地面）
     cv::Mat inverseHomographyMatrix_; // 逆单应性矩阵（从地面到图像）
+    cv::Matx33d homography33_;        // 上面两个矩阵的定长副本，坐标变换直接使用，避免每次访问 cv::Mat
+    cv::Matx33d inverseHomography33_;
+    void updateCachedMatrices();      // 修改单应性矩阵后调用
+    
+    // 图像→地面查找表相关成员变量
+    std::shared_ptr<const GroundLookupTable> groundLut_; // 未启用或未标定时为空；只通过 std::atomic_load/atomic_store 访问
+    cv::Size groundLutImageSize_;
+    int groundLutCellSize_ = 0;       // 0 表示未启用
+    std::string groundLutCachePath_;
+    void rebuildGroundLookupTable();
+    void mapImageToGround(const cv::Point2f* src, cv::Point2f* dst, size_t count) const; // 优先查表
     
     // ArUco 标记相关成员变量
     cv::Ptr<cv::aruco::Dictionary> markerDictionary_; // ArUco 标记字典
     cv::Ptr<cv::aruco::DetectorParameters> detectorParams_; // 检测参数
     std::map<int, cv::Point2f> markerGroundCoordinates_; // 标记ID到地面坐标的映射
+    double arucoDetectionScale_ = 1.0;                        // 候选检测的缩放比例，1 表示单级检测
+    cv::Ptr<cv::aruco::DetectorParameters> coarseDetectorParams_; // 缩小图像上使用的参数，检测时从 detectorParams_ 刷新
+    cv::Mat arucoSmallFrame_;                                 // 缩小后的检测图像（复用缓冲区）
+    bool detectArUcoMarkersTwoScale(const cv::Mat& frame, std::vector<int>& markerIds,
+                                    std::vector<std::vector<cv::Point2f>>& markerCorners);
     bool calibrated_;              // 是否已标定
     
     // 坐标系设置相关成员变量
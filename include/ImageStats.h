@@ -0,0 +1,19 @@
+#ifndef IMAGE_STATS_H
+#define IMAGE_STATS_H
+
+#include <opencv2/opencv.hpp>
+
+// 灰度图的质量统计量
+struct GrayImageStats {
+    double mean = 0.0;               // 亮度均值
+    double stddev = 0.0;             // 亮度标准差（对比度）
+    double laplacianVariance = 0.0;  // 拉普拉斯响应的方差（清晰度）
+};
+
+// 单遍计算灰度图（CV_8UC1）的亮度均值、标准差和拉普拉斯方差
+// 结果与 cv::Laplacian(ksize=1, BORDER_REFLECT_101) + cv::meanStdDev + cv::mean 一致：
+// 拉普拉斯响应在 int16 中计算，累加全部使用整数，不生成 CV_64F 的中间图像；
+// 使用 OpenCV 通用指令集（universal intrinsics）向量化，不支持时退回标量实现
+GrayImageStats computeGrayImageStats(const cv::Mat& gray);
+
+#endif // IMAGE_STATS_H
@@ -0,0 +1,48 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的线程池，用于把一帧的计算拆成若干块并行完成（例如按行带并行 remap）
+// - parallelFor() 阻塞到所有任务完成；调用线程也参与执行，因此 threadCount 个线程中有一个是调用者
+// - 任务按原子计数动态领取，各块耗时不均时也能自动平衡
+// - 多个线程同时调用 parallelFor() 时按顺序执行
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount);  // threadCount 包括调用线程，<= 1 时不创建工作线程
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int threadCount() const { return static_cast<int>(workers_.size()) + 1; }
+
+    // 执行 task(0) .. task(taskCount - 1)，全部完成后返回；任务抛出的第一个异常在调用线程重新抛出
+    void parallelFor(int taskCount, const std::function<void(int)>& task);
+
+private:
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> workers_;
+    std::mutex callMutex_;                 // 串行化并发的 parallelFor() 调用
+    std::mutex mutex_;
+    std::condition_variable wake_;         // 通知工作线程有新一批任务
+    std::condition_variable done_;         // 通知调用者工作线程都已完成
+    const std::function<void(int)>* task_ = nullptr;
+    int taskCount_ = 0;
+    std::atomic<int> nextTask_{0};
+    int activeWorkers_ = 0;
+    uint64_t generation_ = 0;              // 每批任务递增，工作线程据此判断是否有新任务
+    bool stopping_ = false;
+    std::exception_ptr error_;
+};
+
+#endif // THREAD_POOL_H
@@ -5,9 +5,24 @@
 #include <mutex>
 #include <atomic>
 #include <unordered_set>
+#include <unordered_map>
+#include <deque>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
 #include <crow.h>
 #include "HomographyMapper.h"
 #include "CameraCalibrator.h"
+#include "ChessboardTracker.h"
+#include "BirdsEyeView.h"
+#include "ArUcoDetectionWorker.h"
+#include "EncodedFrame.h"
+#include "Frame.h"
+#include "FramePool.h"
+#include "CaptureBackend.h"
+#include "FrameQueue.h"
 
 using namespace std;
 using Connection = crow::websocket::connection*;
@@ -18,10 +33,26 @@ public:
     ~VideoStreamer();
 
     bool initialize(int camera_id = -1, int width = 1280, int height = 720, int fps = 30);
+    // 选择采集后端，需在 initialize() 之前调用；device 为空时使用 /dev/video<camera_id>
+    void setCaptureBackend(CaptureBackendType type, const std::string& device = "", int bufferCount = 4,
+                           CapturePixelFormat format = CapturePixelFormat::MJPEG);
+    CaptureBackendType getCaptureBackendType() const;
     void start();
     void stop();
+    // 离线驱动（基准测试、无摄像头回放）：不打开采集设备，由调用方逐帧送入 BGR 图像
+    // startOffline() 只启动编码线程池和发送线程；submitOfflineFrame() 在调用线程上完成处理线程对一帧所做的处理
+    // （校正、叠加绘制、准备广播），帧的所有权交给处理阶段，像素会被原地绘制。连接照常通过 handleWebSocket() 注册
+    bool startOffline(int width, int height, int fps = 30);
+    bool submitOfflineFrame(cv::Mat frame);
+    // 每发送完一帧在发送线程中调用一次（sendMs 为分发给所有连接的耗时），须尽快返回；在 start()/startOffline() 之前设置
+    using DeliveryObserver = std::function<void(const EncodedFrame& frame, double sendMs)>;
+    void setDeliveryObserver(DeliveryObserver observer);
+    // 每准备好一帧广播在处理线程中调用一次（离线驱动时即 submitOfflineFrame() 的调用线程）：
+    // frameGetMs 为取得广播帧（复制或缩放）的耗时，overlayMs 为叠加绘制耗时；在 start()/startOffline() 之前设置
+    using BroadcastObserver = std::function<void(double frameGetMs, double overlayMs)>;
+    void setBroadcastObserver(BroadcastObserver observer);
     void broadcastFrame();
-    bool getFrame(cv::Mat& frame);
+    FramePtr getFrame() const; // 最新帧的只读快照，不复制像素数据
     bool autoDetectCamera();
     std::vector<std::pair<int, int>> getSupportedResolutions();
     bool setResolution(int width, int height);
@@ -42,6 +73,8 @@ public:
     std::vector<std::pair<cv::Point2f, cv::Point2f>> getCalibrationPoints() const;
     void drawCalibrationPoints(cv::Mat& frame);
     cv::Mat getHomographyMatrix() const; // 获取单应性矩阵数据
+    // 按当前采集分辨率启用图像→地面查找表（cellSize 为网格间距，1 为稠密表），缓存文件与标定文件放在同一目录
+    void enableGroundLookupTable(int cellSize);
     
     // 坐标变换标定模式控制
     bool toggleCalibrationMode(); // 切换标定模式
@@ -50,7 +83,6 @@ public:
     // ArUco 标记相关方法
     bool toggleArUcoMode();
     bool isArUcoMode() const;
-    bool detectArUcoMarkers(cv::Mat& frame);
     bool calibrateFromArUcoMarkers();
     bool setMarkerGroundCoordinates(int markerId, const cv::Point2f& groundCoord);
     bool saveMarkerCoordinates(const std::string& filename = "");
@@ -63,6 +95,8 @@ public:
     void getArUcoDetectionParameters(int& adaptiveThreshWinSizeMin, int& adaptiveThreshWinSizeMax, 
                                     int& adaptiveThreshWinSizeStep, double& adaptiveThreshConstant) const;
     int getArUcoCornerRefinementMethod() const;
+    void setArUcoDetectionScale(double scale);   // < 1 时启用两级检测（缩小找候选 + 全分辨率细化）
+    double getArUcoDetectionScale() const;
 
     // 相机标定相关方法
     void setCameraCalibrationMode(bool mode);
@@ -91,8 +125,8 @@ public:
     // 双分辨率支持
     void setDisplayResolution(int width, int height);
     void setDetectionResolution(int width, int height);
-    cv::Mat getDisplayFrame();
-    cv::Mat getDetectionFrame();
+    FramePtr getDisplayFrame();         // 显示分辨率的只读快照（分辨率相同时不复制）
+    FramePtr getDetectionFrame() const; // 检测用原始分辨率的只读快照
 
     // 棋盘格和质量设置
     void setChessboardSize(int width, int height);
@@ -100,6 +134,10 @@ public:
     void setBlurKernelSize(int size);
     int getBlurKernelSize() const;
     void setQualityCheckLevel(int level);
+    void setParallelChessboardDetectionEnabled(bool enabled);  // 回退检测策略并行执行，第一个成功的立即返回
+    bool isParallelChessboardDetectionEnabled() const;
+    std::vector<CameraCalibrator::ChessboardStrategyStats> getChessboardStrategyStats() const;
+    CalibrationImageWriter::Stats getCalibrationWriterStats() const;  // 标定图像后台写入的队列深度和写入耗时
     double getCalibrationError() const;
     bool isCameraCalibrated() const;
     size_t getCalibrationImageCount() const;
@@ -107,27 +145,263 @@ public:
     // 相机校正控制
     void setCameraCorrectionEnabled(bool enabled);
     bool isCameraCorrectionEnabled() const;
+    void setUndistortThreadCount(int count); // 并行去畸变的线程数（包括处理线程本身）
+    int getUndistortThreadCount() const;
+    
+    // 校正方式：Frame 每帧整帧去畸变；Points 只校正坐标（点击的标定点、ArUco 标记中心），
+    // 只有客户端请求校正后的视频时才整帧去畸变。整帧未去畸变时坐标通过 cv::undistortPoints 校正
+    enum class CorrectionMode { Frame, Points };
+    void setCorrectionMode(CorrectionMode mode);
+    CorrectionMode getCorrectionMode() const;
+    void setCorrectedVideoRequested(bool requested);
+    bool isCorrectedVideoRequested() const;
+    bool isFrameCorrectionActive() const;  // 当前帧是否整帧去畸变
+    bool isPointCorrectionActive() const;  // 坐标是否需要单独去畸变
     
     // 系统性能监控
     std::string getSystemResourceInfo();
+    uint64_t getBroadcastBytesCopiedPerSecond() const; // 广播路径每秒复制的字节数
+    
+    // 流水线阶段统计：采集 -> 处理 -> 编码 -> 发送
+    struct PipelineStageStats {
+        std::string name;          // 阶段名称
+        size_t queueDepth = 0;     // 输入队列当前深度
+        size_t queueCapacity = 0;  // 输入队列容量
+        uint64_t dropped = 0;      // 输入队列满时丢弃的帧数（累计）
+        uint64_t processed = 0;    // 本阶段处理完成的帧数（累计）
+    };
+    std::vector<PipelineStageStats> getPipelineStats() const;
+    
+    // 并行JPEG编码：多个编码线程同时编码相邻帧，发送前按序号重新排序
+    enum class LateFramePolicy {
+        Drop,     // 丢弃晚到的帧（默认，保证帧顺序）
+        Deliver   // 晚到的帧仍然发送（可能乱序，但不丢帧）
+    };
+    void setEncoderThreadCount(int count);  // 在 start() 之前调用生效
+    int getEncoderThreadCount() const;
+    void setLateFramePolicy(LateFramePolicy policy);
+    LateFramePolicy getLateFramePolicy() const;
+    void setReorderTimeout(int milliseconds); // 等待缺失帧的最长时间
+    
+    // MJPEG直通：没有叠加、校正或标定需求时，直接转发摄像头输出的JPEG，不解码也不重新编码
+    // 直通期间不绘制状态提示文字；需要像素的消费者会按需解码
+    void setMjpegPassthroughEnabled(bool enabled);
+    bool isMjpegPassthroughEnabled() const;
+    bool isMjpegPassthroughActive() const;   // 摄像头当前是否正在输出原始MJPEG
+    
+    // 分块传输：只重新编码与上次发送相比发生变化的块，定期及新连接时发送完整关键帧
+    void setTiledStreaming(bool enabled, int tileSize = 128);
+    bool isTiledStreaming() const;
+    
+    // 自适应质量：按每个连接的发送积压和确认延迟独立选择质量档位（JPEG质量、分辨率、跳帧），
+    // 同一档位的连接共享一次编码结果；客户端每处理完一帧回复一次 frame_ack
+    // 从不回复确认的客户端固定使用最高档位；分块传输模式下所有连接共用同一路流
+    struct ClientQualityStats {
+        int tier = 0;                 // 0 为最高档位
+        int quality = 0;
+        double scale = 1.0;
+        int frameSkip = 1;            // 每 frameSkip 帧发送一帧
+        size_t framesInFlight = 0;    // 已发送未确认的帧数
+        size_t outstandingBytes = 0;  // 已发送未确认的字节数
+        double ackLatencyMs = 0.0;    // 确认延迟（滑动平均）
+        bool acknowledging = false;   // 客户端是否发送确认
+    };
+    void acknowledgeFrame(Connection conn);
+    void setAdaptiveQualityEnabled(bool enabled);
+    bool isAdaptiveQualityEnabled() const;
+    std::vector<ClientQualityStats> getClientQualityStats();
+    
+    // 地面俯视（鸟瞰）视图：每个连接可以选择原始画面或鸟瞰视图，鸟瞰帧从原始帧一次 remap 生成（需已完成单应性标定）
+    // groundBounds 为空时取标定点地面坐标的外接矩形（四周各扩展 25%），mmPerPixel <= 0 时按显示分辨率自动选择比例
+    enum class VideoView { Camera, BirdsEye };
+    void setClientVideoView(Connection conn, VideoView view);
+    VideoView getClientVideoView(Connection conn);
+    void setBirdsEyeConfig(const cv::Rect2f& groundBounds, double mmPerPixel);
+    BirdsEyeView::Config getBirdsEyeConfig() const;  // 当前生效的参数（尚未生成鸟瞰帧时为设置值）
+    cv::Size getBirdsEyeOutputSize() const;          // 映射表不可用时为 0x0
+    
+    // ArUco 后台检测：ArUco 模式下检测线程处理最新帧，广播时只绘制最近一次的结果
+    // 结果年龄为最近一次广播帧与所绘制结果所用帧之间相差的采集帧数和时间
+    struct ArUcoDetectionStatus {
+        double maxRate = 0.0;          // 检测频率上限，0 表示不限
+        uint64_t detections = 0;
+        uint64_t replacedFrames = 0;   // 检测跟不上时被跳过的帧数
+        double lastDetectMs = 0.0;
+        double averageDetectMs = 0.0;
+        int64_t resultAgeFrames = -1;  // 尚未绘制过结果时为 -1
+        double resultAgeMs = 0.0;
+    };
+    void setArUcoDetectionRate(double detectionsPerSecond);
+    ArUcoDetectionStatus getArUcoDetectionStatus() const;
 
 private:
+    // 流水线阶段之间传递的数据
+    struct CapturedFrame {
+        cv::Mat image;          // 采集数据，格式见 format（原始格式可能是驱动缓冲区的零拷贝视图）
+        CapturePixelFormat format = CapturePixelFormat::BGR;
+        uint64_t sequence = 0;
+        std::chrono::steady_clock::time_point captureTime;
+    };
+    struct BroadcastJob {
+        cv::Mat image;          // 已绘制叠加层、待编码的帧
+        uint64_t sequence = 0;
+        int quality = 92;
+        bool fastMode = false;
+        int tier = -1;                  // 自适应质量档位，-1 表示发给所有连接
+        double scale = 1.0;             // 编码前的缩放比例
+        bool tileUpdate = false;        // 为真时只编码 tiles 中的块
+        std::vector<cv::Rect> tiles;
+        bool birdsEye = false;          // 鸟瞰视图的帧，只发给选择鸟瞰视图的连接
+        std::chrono::steady_clock::time_point captureTime;
+    };
+    
+    // 每个连接的自适应质量状态（受 conn_mutex_ 保护）
+    static constexpr int kQualityTierCount = 4;
+    struct ClientState {
+        int tier = 0;
+        std::deque<std::pair<size_t, std::chrono::steady_clock::time_point>> inFlight; // 未确认的帧：字节数与发送时间
+        size_t outstandingBytes = 0;
+        double ackLatencyMs = 0.0;
+        bool acknowledging = false;
+        std::chrono::steady_clock::time_point lastTierChange;
+        std::chrono::steady_clock::time_point healthySince;  // 连续状况良好的起始时间，默认值表示当前不佳
+        int infoWidth = 0;       // 最近发给该连接的 frame_info 尺寸
+        int infoHeight = 0;
+        int framesSinceInfo = 0;
+        VideoView view = VideoView::Camera;
+    };
+    
     void captureThread(); // 添加线程函数声明
+    void processThread(); // 处理阶段：校正、标定检测、叠加绘制
+    void encodeThread();  // 编码阶段：JPEG编码
+    void sendThread();    // 发送阶段：分发给所有连接
+    void startEncodeAndSendWorkers(); // 启动编码线程池和发送线程（start() 与 startOffline() 共用）
+    bool processCapturedFrame(CapturedFrame& captured); // 对采集到的帧做校正/标定处理并发布为最新帧
+    bool processPassthroughFrame(CapturedFrame& captured); // 直通帧：原始JPEG直接广播并发布为最新帧
+    bool convertCapturedFrame(CapturedFrame& captured);    // 原始格式（MJPEG/YUYV）转换为BGR
+    bool initializeCaptureBackend(int camera_id, int width, int height, int fps);
+    bool isCaptureOpened() const;
+    bool prepareTileUpdate(const cv::Mat& frame, BroadcastJob& job); // 计算变化块，返回本帧是否需要发送
+    EncodedFramePtr encodeTileUpdate(const BroadcastJob& job);       // 编码变化块为 TILE 消息
+    bool acquireBroadcastSlot(size_t& connectionCount); // 连接检查与帧率控制，返回本帧是否需要广播
+    bool needsDecodedFrames() const; // 是否有功能需要解码后的像素
+    bool needsFullResolutionFrames(); // 是否有消费者需要高于显示分辨率的校正帧
+    bool undistortCapturedFrame(cv::Mat& frame, cv::Mat& displayFrame); // 校正并按需缩放到已登记的输出分辨率
+    bool renderBirdsEyeFrame(const cv::Mat& rawFrame, cv::Mat& birdsEyeFrame); // 原始帧（未去畸变）-> 鸟瞰视图
+    void drawArUcoDetections(cv::Mat& frame, const Frame& source); // 绘制后台检测的最新结果并记录结果年龄
+    void notifyArUcoDetection(const ArUcoDetectionResult& result); // 标记数量变化时通知所有连接
+    FramePtr currentFrame() const;   // 最新帧快照，直通帧在此按需解码
     void sendCameraInfo(Connection conn); // 发送摄像头信息给客户端
+    EncodedFramePtr encodeBroadcastFrame(const BroadcastJob& job); // 编码一次，供同一档位的所有连接共享
+    void sendEncodedFrame(const EncodedFramePtr& encoded); // 将共享的编码帧分发给对应档位的连接
+    void activeQualityTiers(bool cameraTiers[], bool birdsEyeTiers[]); // 两种视图下当前至少有一个连接使用的档位
+    void updateClientTier(ClientState& state, std::chrono::steady_clock::time_point now); // 调用方持有 conn_mutex_
     void autoCalibrationCaptureThread(int durationSeconds, int intervalMs); // 添加自动采集线程声明
     
     cv::VideoCapture cap_;
+    // 非空时代替 cap_ 采集；指针的替换和后端的打开/关闭都在 captureBackendMutex_ 下进行，
+    // 其他线程读取后端信息时也持有该锁，采集线程自己的 read() 不加锁（恢复也在采集线程中进行）
+    std::unique_ptr<CaptureBackend> captureBackend_;
+    mutable std::mutex captureBackendMutex_;
+    CaptureConfig captureConfig_;                     // 最近一次成功打开后端的配置，恢复时原样重新打开
+    CaptureBackendType captureBackendType_{CaptureBackendType::OpenCV};
+    std::string captureDevice_;
+    int captureBufferCount_{4};
+    CapturePixelFormat captureFormat_{CapturePixelFormat::MJPEG};
     std::atomic<bool> running_{false};
     std::thread worker_;
-    std::mutex mutex_;
-    cv::Mat frame_;
-    cv::Mat detectionFrame_;  // 用于检测的原始高分辨率帧
+    std::thread processWorker_;
+    std::vector<std::thread> encodeWorkers_;
+    std::thread sendWorker_;
+    mutable FrameSlot latestFrame_;   // 最新处理帧（显示与检测共用同一份只读数据；直通帧解码后回填）
     int width_;
     int height_;
     int fps_;
     std::unordered_set<Connection> connections_;
+    std::unordered_map<Connection, ClientState> clientStates_;
     std::mutex conn_mutex_;
     
+    // 阶段耗时累计，发送线程每5秒汇总一次
+    struct StageTimer {
+        std::atomic<uint64_t> micros{0};
+        std::atomic<uint64_t> count{0};
+        void add(double ms) {
+            micros += static_cast<uint64_t>(ms * 1000.0);
+            count++;
+        }
+        double averageAndReset() {
+            uint64_t n = count.exchange(0);
+            uint64_t us = micros.exchange(0);
+            return n > 0 ? us / 1000.0 / n : 0.0;
+        }
+    };
+    
+    // 有界队列：满时丢弃最旧的帧，慢阶段不会反压采集
+    BoundedFrameQueue<CapturedFrame> captureQueue_{2};
+    // 一帧最多产生 kQualityTierCount * 2 个编码任务（每个档位的原始画面和鸟瞰视图），
+    // 编码队列至少容纳两帧的任务，避免同一帧的任务互相挤掉
+    BoundedFrameQueue<BroadcastJob> encodeQueue_{kQualityTierCount * 2 * 2};
+    BoundedFrameQueue<EncodedFramePtr> sendQueue_{kQualityTierCount * 2 * 4};  // 多个编码线程写入，容量需覆盖重排窗口
+    // 在编码/发送队列中被丢弃或编码失败、永远不会到达发送线程的广播序号，发送线程据此立即跳过缺口
+    BoundedFrameQueue<uint64_t> abandonedSequences_{64};
+    std::atomic<uint64_t> broadcastSequence_{0};
+    std::atomic<uint64_t> capturedFrames_{0};
+    std::atomic<uint64_t> processedFrames_{0};
+    std::atomic<uint64_t> encodedFrames_{0};
+    std::atomic<uint64_t> sentFrames_{0};
+    StageTimer frameGetTimer_;
+    StageTimer overlayTimer_;
+    StageTimer encodeTimer_;
+    StageTimer sendTimer_;
+    StageTimer latencyTimer_;            // 采集到发送完成的端到端延迟
+    DeliveryObserver deliveryObserver_;  // 只在流水线停止时设置，发送线程只读
+    BroadcastObserver broadcastObserver_;  // 只在流水线停止时设置，处理线程只读
+    uint64_t offlineSequence_{0};        // 离线送入帧的采集序号（仅调用 submitOfflineFrame 的线程访问）
+    
+    // 并行编码与按序发送
+    std::atomic<int> encoderThreadCount_{4};
+    std::atomic<LateFramePolicy> lateFramePolicy_{LateFramePolicy::Drop};
+    std::atomic<int> reorderTimeoutMs_{100};
+    std::atomic<uint64_t> lateFrames_{0};     // 晚到的帧数（累计）
+    std::atomic<uint64_t> skippedGaps_{0};    // 因超时跳过的缺失序号数（累计）
+    std::atomic<size_t> lastPayloadSize_{0};  // 最近一帧的JPEG大小
+    
+    // 分块传输（参考帧仅由处理线程访问）
+    std::atomic<bool> tiledStreaming_{false};
+    // 分块参数由 WebSocket 线程设置、处理线程读取，处理线程每帧读取一次
+    std::atomic<int> tileSize_{128};
+    std::atomic<double> tileChangeThreshold_{3.0};  // 块内平均每像素每通道的绝对差阈值
+    std::atomic<int> keyframeInterval_{60};         // 每隔多少个广播帧强制发送关键帧
+    int framesSinceKeyframe_{0};
+    std::atomic<bool> tileKeyframePending_{true};
+    cv::Mat tileReference_;            // 客户端当前画面（上次发送内容）
+    std::atomic<uint64_t> tilesEncoded_{0};
+    std::atomic<uint64_t> tilesTotal_{0};
+    std::atomic<uint64_t> keyframesSent_{0};
+    
+    // MJPEG直通
+    std::atomic<bool> mjpegPassthroughEnabled_{true};
+    std::atomic<bool> mjpegPassthroughSupported_{true};  // 后端不支持原始输出时自动关闭
+    std::atomic<bool> mjpegPassthroughActive_{false};
+    std::atomic<uint64_t> passthroughFrames_{0};         // 直通广播的帧数（累计）
+    mutable std::atomic<uint64_t> passthroughDecodes_{0}; // 直通帧按需解码次数（累计）
+    
+    // 自适应质量
+    std::atomic<bool> adaptiveQualityEnabled_{true};
+    std::atomic<int> degradedClients_{0};                 // 不在最高档位的连接数，非零时需要重新编码，不能直通
+    uint64_t tierFrameCounters_[kQualityTierCount] = {};  // 各档位的跳帧计数（仅处理线程访问）
+    struct PendingFrame {
+        EncodedFramePtr frame;  // 为空表示该序号已被放弃，只占位
+        std::chrono::steady_clock::time_point arrival;
+    };
+    void deliverEncodedFrame(const EncodedFramePtr& encoded); // 发送单帧并统计
+    bool pushEncodeJob(BroadcastJob job);                     // 入编码队列，被挤掉的任务记为放弃的序号
+    void pushEncodedFrame(EncodedFramePtr encoded);           // 入发送队列，被挤掉的帧记为放弃的序号
+    
+    // 广播路径内存复制统计
+    std::atomic<uint64_t> broadcastBytesCopied_{0};          // 当前统计周期内复制的字节数
+    std::atomic<uint64_t> broadcastBytesCopiedPerSecond_{0}; // 最近一个统计周期的每秒复制字节数
+    
     // 单应性矩阵相关成员
     HomographyMapper homographyMapper_;
     bool calibrationMode_{false};  // 标定模式标志
@@ -135,10 +409,22 @@ private:
     
     // ArUco 标记相关成员
     bool arucoMode_{false};  // ArUco 标记检测模式
+    mutable std::mutex arucoDetectMutex_;  // HomographyMapper 的检测缓冲区和参数不可重入，后台检测、标定时的检测和参数读写互斥
+    // 后台检测线程（在 homographyMapper_ 之后声明，先于它析构）
+    ArUcoDetectionWorker arucoWorker_{[this](const cv::Mat& frame, std::vector<int>& ids,
+                                             std::vector<std::vector<cv::Point2f>>& corners) {
+        std::lock_guard<std::mutex> lock(arucoDetectMutex_);
+        return homographyMapper_.detectArUcoMarkers(frame, ids, corners);
+    }};
+    ArUcoDetectionResultPtr arucoNotifiedResult_;     // 最近一次检查过是否需要通知的结果（仅广播线程访问）
+    int arucoNotifiedMarkerCount_{-1};                // 最近一次通知前端的标记数量（仅广播线程访问）
+    std::atomic<int64_t> arucoResultAgeFrames_{-1};
+    std::atomic<double> arucoResultAgeMs_{0.0};
     std::string markerCoordinatesFilePath_{"/home/radxa/Qworkspace/VideoMapping/data/markers.xml"}; // 标记地面坐标文件路径
 
     // 相机标定相关成员
     CameraCalibrator cameraCalibrator_; // 相机标定器
+    ChessboardTracker chessboardTracker_; // 相机标定模式下逐帧跟踪棋盘格角点（仅处理线程使用）
     bool cameraCalibrationMode_{false}; // 相机标定模式标志
     std::string cameraCalibrationFilePath_{"/home/radxa/Qworkspace/VideoMapping/data/camera_calibration.xml"}; // 相机标定文件路径
 
@@ -149,9 +435,22 @@ private:
     // 双分辨率支持
     int displayWidth_, displayHeight_;
     int detectionWidth_, detectionHeight_;
+    mutable std::atomic<int64_t> displayFrameRequestTime_{0};  // 最近一次 getDisplayFrame() 的时间（steady_clock 计数）
+    std::vector<cv::Size> undistortOutputSizes_;               // 当前使用的校正输出分辨率（仅处理线程访问）
     
     // 相机校正控制
     std::atomic<bool> cameraCorrectionEnabled_{false};
+    std::atomic<CorrectionMode> correctionMode_{CorrectionMode::Frame};
+    std::atomic<bool> correctedVideoRequested_{false};  // Points 模式下客户端是否需要校正后的视频
+    
+    // 鸟瞰视图（映射表仅由处理线程访问）
+    BirdsEyeView birdsEyeView_;
+    std::atomic<int> birdsEyeClients_{0};           // 选择鸟瞰视图的连接数，非零时处理线程才生成鸟瞰帧
+    mutable std::mutex birdsEyeMutex_;              // 保护下面两个参数
+    BirdsEyeView::Config birdsEyeRequested_;        // 用户设置的参数，空值表示自动选择
+    BirdsEyeView::Config birdsEyeActive_;           // 实际生效的参数
+    std::atomic<int> birdsEyeWidth_{0};
+    std::atomic<int> birdsEyeHeight_{0};
     
     // 错误处理和通知
     std::atomic<int> frameReadFailureCount_{0};  // 帧读取失败计数器
@@ -0,0 +1,114 @@
+#include "../include/ArUcoDetectionWorker.h"
+#include <algorithm>
+#include <iostream>
+
+ArUcoDetectionWorker::ArUcoDetectionWorker(Detector detector) : detector_(std::move(detector)) {}
+
+ArUcoDetectionWorker::~ArUcoDetectionWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ArUcoDetectionWorker::submit(FramePtr frame) {
+    if (!frame || frame->image.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        if (!thread_.joinable()) {
+            thread_ = std::thread(&ArUcoDetectionWorker::workerLoop, this);
+        }
+        if (pending_) {
+            stats_.replacedFrames++;
+        }
+        pending_ = std::move(frame);
+    }
+    wake_.notify_one();
+}
+
+ArUcoDetectionResultPtr ArUcoDetectionWorker::latest() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_;
+}
+
+void ArUcoDetectionWorker::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.reset();
+    latest_.reset();
+    generation_++;
+}
+
+void ArUcoDetectionWorker::setMaxRate(double detectionsPerSecond) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.maxRate = std::max(0.0, detectionsPerSecond);
+        nextDetection_ = std::chrono::steady_clock::time_point();  // 按新频率从下一帧开始计时
+    }
+    wake_.notify_all();
+}
+
+ArUcoDetectionWorker::Stats ArUcoDetectionWorker::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ArUcoDetectionWorker::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || pending_; });
+        if (stopping_) {
+            return;
+        }
+
+        // 限速：等到允许的时间再取帧，等待期间到达的新帧会替换旧帧
+        if (stats_.maxRate > 0.0 && std::chrono::steady_clock::now() < nextDetection_) {
+            wake_.wait_until(lock, nextDetection_, [this] {
+                return stopping_ || std::chrono::steady_clock::now() >= nextDetection_;
+            });
+            continue;  // 重新检查退出标志和待检测帧（reset() 可能已清空）
+        }
+
+        FramePtr frame = std::move(pending_);
+        pending_.reset();
+        const uint64_t generation = generation_;
+        auto start = std::chrono::steady_clock::now();
+        if (stats_.maxRate > 0.0) {
+            nextDetection_ = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                         std::chrono::duration<double>(1.0 / stats_.maxRate));
+        }
+        lock.unlock();
+
+        auto result = std::make_shared<ArUcoDetectionResult>();
+        result->sequence = frame->sequence;
+        result->timestamp = frame->timestamp;
+        result->imageSize = frame->image.size();
+        try {
+            detector_(frame->image, result->markerIds, result->markerCorners);
+        } catch (const std::exception& e) {
+            std::cerr << "[ArUco ERROR] 后台检测异常: " << e.what() << std::endl;
+            result->markerIds.clear();
+            result->markerCorners.clear();
+        }
+        result->detectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        frame.reset();  // 尽早归还帧缓冲区
+
+        lock.lock();
+        if (generation != generation_) {
+            continue;  // 检测期间调用了 reset()，结果作废
+        }
+        latest_ = std::move(result);
+        stats_.detections++;
+        stats_.lastDetectMs = latest_->detectMs;
+        totalDetectMs_ += latest_->detectMs;
+        stats_.averageDetectMs = totalDetectMs_ / stats_.detections;
+    }
+}
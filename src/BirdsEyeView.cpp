@@ -0,0 +1,149 @@
+#include "../include/BirdsEyeView.h"
+#include "../include/FramePool.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+bool BirdsEyeView::prepare(const Config& config, const cv::Matx33d& groundToImage, const cv::Size& inputSize,
+                           const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, uint64_t calibrationVersion) {
+    // 参数与上次相同时直接返回上次的结果（失败的参数也不再重复尝试和报错）
+    const bool distorted = !cameraMatrix.empty() && !distCoeffs.empty();
+    if (prepared_ && config.groundBounds == config_.groundBounds && config.mmPerPixel == config_.mmPerPixel &&
+        std::equal(groundToImage.val, groundToImage.val + 9, groundToImage_.val) && inputSize == inputSize_ &&
+        distorted == distorted_ && (!distorted || calibrationVersion == calibrationVersion_)) {
+        return isReady();
+    }
+
+    clear();
+    prepared_ = true;
+    config_ = config;
+    groundToImage_ = groundToImage;
+    inputSize_ = inputSize;
+    distorted_ = distorted;
+    calibrationVersion_ = calibrationVersion;
+
+    if (config.mmPerPixel <= 0.0 || config.groundBounds.width <= 0.0f || config.groundBounds.height <= 0.0f ||
+        inputSize.width <= 0 || inputSize.height <= 0) {
+        std::cerr << "❌ [BIRDS EYE] Invalid view parameters" << std::endl;
+        return false;
+    }
+    cv::Size outputSize(static_cast<int>(std::ceil(config.groundBounds.width / config.mmPerPixel)),
+                        static_cast<int>(std::ceil(config.groundBounds.height / config.mmPerPixel)));
+    if (outputSize.width > kMaxOutputSide || outputSize.height > kMaxOutputSide) {
+        std::cerr << "❌ [BIRDS EYE] Output " << outputSize.width << "x" << outputSize.height << " exceeds "
+                  << kMaxOutputSide << " pixels per side, increase mm per pixel" << std::endl;
+        return false;
+    }
+    outputSize_ = outputSize;
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        if (!buildMaps(cameraMatrix, distCoeffs)) {
+            map1_.release();
+            map2_.release();
+            return false;
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "❌ [BIRDS EYE] Failed to build warp maps: " << e.what() << std::endl;
+        map1_.release();
+        map2_.release();
+        return false;
+    }
+    lastBuildMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "🗺️ [BIRDS EYE] Built " << outputSize_.width << "x" << outputSize_.height << " warp maps ("
+              << config_.mmPerPixel << " mm/px" << (distorted_ ? ", with lens distortion" : "") << ") in "
+              << lastBuildMs_ << "ms" << std::endl;
+    return true;
+}
+
+bool BirdsEyeView::buildMaps(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs) {
+    const cv::Matx33d& m = groundToImage_;
+
+    // 地面点在相机前方时齐次坐标 w 的符号与画面中心对应的地面点相同，符号相反的点在地平线以上
+    cv::Matx33d imageToGround = m.inv();
+    cv::Vec3d centre = imageToGround * cv::Vec3d(inputSize_.width * 0.5, inputSize_.height * 0.5, 1.0);
+    if (std::fabs(centre[2]) <= DBL_EPSILON) {
+        std::cerr << "❌ [BIRDS EYE] Homography maps the image centre to infinity" << std::endl;
+        return false;
+    }
+    const double visibleSign = (m(2, 0) * centre[0] + m(2, 1) * centre[1] + m(2, 2) * centre[2]) / centre[2] > 0 ? 1.0 : -1.0;
+
+    // 投影到远离画面的位置时高阶畸变模型会折返到画面内，只保留画面附近的点
+    const float marginX = inputSize_.width * 0.5f;
+    const float marginY = inputSize_.height * 0.5f;
+    cv::Rect2f usable(-marginX, -marginY, inputSize_.width + 2 * marginX, inputSize_.height + 2 * marginY);
+
+    cv::Matx33d K;
+    if (distorted_) {
+        cv::Mat K64;
+        cameraMatrix.convertTo(K64, CV_64F);
+        K = cv::Matx33d(K64.ptr<double>());
+    }
+
+    cv::Mat map(outputSize_, CV_32FC2);
+    std::vector<cv::Point3f> normalized;
+    std::vector<cv::Point2f> projected;
+    std::vector<int> columns;
+    const cv::Mat zeroVector = cv::Mat::zeros(3, 1, CV_64F);  // 无旋转、无平移
+    const cv::Point2f invalid(-1.0f, -1.0f);                  // 落在输入图像外，remap 输出边界颜色
+    for (int v = 0; v < outputSize_.height; ++v) {
+        cv::Point2f* row = map.ptr<cv::Point2f>(v);
+        const double gy = config_.groundBounds.y + (v + 0.5) * config_.mmPerPixel;
+        normalized.clear();
+        columns.clear();
+        for (int u = 0; u < outputSize_.width; ++u) {
+            const double gx = config_.groundBounds.x + (u + 0.5) * config_.mmPerPixel;
+            const double w = m(2, 0) * gx + m(2, 1) * gy + m(2, 2);
+            if (w * visibleSign <= FLT_EPSILON) {
+                row[u] = invalid;
+                continue;
+            }
+            cv::Point2f p(static_cast<float>((m(0, 0) * gx + m(0, 1) * gy + m(0, 2)) / w),
+                          static_cast<float>((m(1, 0) * gx + m(1, 1) * gy + m(1, 2)) / w));
+            if (!usable.contains(p)) {
+                row[u] = invalid;
+            } else if (distorted_) {
+                // 反投影到归一化平面，整行收集后带畸变投影回原始图像
+                normalized.emplace_back(static_cast<float>((p.x - K(0, 2)) / K(0, 0)),
+                                        static_cast<float>((p.y - K(1, 2)) / K(1, 1)), 1.0f);
+                columns.push_back(u);
+            } else {
+                row[u] = p;
+            }
+        }
+        if (!normalized.empty()) {
+            cv::projectPoints(normalized, zeroVector, zeroVector, cameraMatrix, distCoeffs, projected);
+            for (size_t i = 0; i < columns.size(); ++i) {
+                row[columns[i]] = projected[i];
+            }
+        }
+    }
+
+    cv::convertMaps(map, cv::noArray(), map1_, map2_, CV_16SC2);
+    return true;
+}
+
+bool BirdsEyeView::warp(const cv::Mat& frame, cv::Mat& output) const {
+    if (!isReady() || frame.size() != inputSize_) {
+        return false;
+    }
+    try {
+        output = FramePool::instance().acquire(outputSize_, frame.type());
+        cv::remap(frame, output, map1_, map2_, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar::all(0));
+        return true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "❌ [BIRDS EYE] Warp failed: " << e.what() << std::endl;
+        output.release();
+        return false;
+    }
+}
+
+void BirdsEyeView::clear() {
+    map1_.release();
+    map2_.release();
+    outputSize_ = cv::Size();
+    prepared_ = false;
+}
@@ -0,0 +1,138 @@
+#include "../include/CalibrationImageWriter.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+CalibrationImageWriter::CalibrationImageWriter(size_t capacity, OverflowPolicy policy)
+    : capacity_(std::max<size_t>(1, capacity)), policy_(policy) {
+    stats_.capacity = capacity_;
+}
+
+CalibrationImageWriter::~CalibrationImageWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool CalibrationImageWriter::enqueue(CalibrationImageJob job, std::string* droppedPath) {
+    bool accepted = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            if (droppedPath) {
+                *droppedPath = job.path;
+            }
+            return false;
+        }
+        if (!thread_.joinable()) {
+            thread_ = std::thread(&CalibrationImageWriter::writerLoop, this);
+        }
+
+        if (queue_.size() >= capacity_) {
+            stats_.dropped++;
+            accepted = false;
+            if (policy_ == OverflowPolicy::DropNewest) {
+                std::cerr << "⚠️ [CALIB WRITER] Queue full, dropped " << job.path << std::endl;
+                if (droppedPath) {
+                    *droppedPath = job.path;
+                }
+                return false;
+            }
+            std::cerr << "⚠️ [CALIB WRITER] Queue full, dropped " << queue_.front().path << std::endl;
+            if (droppedPath) {
+                *droppedPath = queue_.front().path;
+            }
+            queue_.pop_front();
+        }
+        queue_.push_back(std::move(job));
+        stats_.queueDepth = queue_.size();
+    }
+    wake_.notify_one();
+    return accepted;
+}
+
+bool CalibrationImageWriter::waitUntilIdle(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return idle_.wait_for(lock, timeout, [this] { return queue_.empty() && !writing_; });
+}
+
+void CalibrationImageWriter::setOverflowPolicy(OverflowPolicy policy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    policy_ = policy;
+}
+
+CalibrationImageWriter::Stats CalibrationImageWriter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void CalibrationImageWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;  // 退出前已写完队列中的所有图像
+        }
+
+        CalibrationImageJob job = std::move(queue_.front());
+        queue_.pop_front();
+        stats_.queueDepth = queue_.size();
+        writing_ = true;
+        lock.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        bool success = writeJob(job);
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        writing_ = false;
+        if (success) {
+            stats_.written++;
+        } else {
+            stats_.failed++;
+        }
+        totalWriteMs_ += elapsedMs;
+        stats_.lastWriteMs = elapsedMs;
+        stats_.maxWriteMs = std::max(stats_.maxWriteMs, elapsedMs);
+        stats_.averageWriteMs = totalWriteMs_ / (stats_.written + stats_.failed);
+        if (queue_.empty()) {
+            idle_.notify_all();
+        }
+    }
+}
+
+bool CalibrationImageWriter::writeJob(const CalibrationImageJob& job) {
+    try {
+        // 确保目录存在（只在目录变化时访问文件系统）
+        std::string directory = std::filesystem::path(job.path).parent_path().string();
+        if (!directory.empty() && directory != createdDirectory_) {
+            std::filesystem::create_directories(directory);
+            createdDirectory_ = directory;
+        }
+
+        // 在图像副本上绘制检测到的角点和质量信息
+        cv::Mat annotated = job.image.clone();
+        if (!job.corners.empty()) {
+            cv::drawChessboardCorners(annotated, job.boardSize, job.corners, true);
+        }
+        if (!job.caption.empty()) {
+            cv::putText(annotated, job.caption, cv::Point(10, 30),
+                       cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(226, 43, 138), 2); // 紫色 (138, 43, 226) 表示成功
+        }
+
+        if (!cv::imwrite(job.path, annotated)) {
+            std::cerr << "❌ Failed to save calibration image: " << job.path << std::endl;
+            return false;
+        }
+        std::cout << "✅ Successfully saved calibration image: " << job.path << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Error saving calibration image " << job.path << ": " << e.what() << std::endl;
+        return false;
+    }
+}
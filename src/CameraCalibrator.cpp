@@ -1,4 +1,7 @@
 #include "CameraCalibrator.h"
+#include "FramePool.h"
+#include "ImageStats.h"
+#include "CalibrationImageWriter.h"
 #include <opencv2/calib3d.hpp>
 #include <iostream>
 #include <ctime>  // 添加time.h头文件
@@ -7,6 +10,8 @@
 #include <iomanip>     // 添加iomanip头文件
 #include <limits>      // 添加limits头文件
 #include <chrono>      // 添加chrono头文件
+#include <algorithm>
+#include <thread>
 
 CameraCalibrator::CameraCalibrator() 
     : boardSize(8, 5)  // 默认9x6的棋盘格，角点数是8x5
@@ -28,6 +33,12 @@ CameraCalibrator::CameraCalibrator()
     initializeExistingImageCount();
 }
 
+CameraCalibrator::~CameraCalibrator() {
+    // 并行检测落选的策略线程仍会访问本对象（预处理缓冲区、策略统计），须等它们结束
+    std::unique_lock<std::mutex> lock(detectionMutex);
+    strategiesFinished.wait(lock, [this] { return runningStrategies == 0; });
+}
+
 void CameraCalibrator::initializeExistingImageCount() {
     try {
         std::string calibDir = "calibration_images";
@@ -82,7 +93,8 @@ void CameraCalibrator::setSquareSize(float size) {
 }
 
 // 公共棋盘格检测方法，供前端和后端共用
-bool CameraCalibrator::detectChessboard(const cv::Mat& image, std::vector<cv::Point2f>& corners, bool isForCalibration) {
+bool CameraCalibrator::detectChessboard(const cv::Mat& image, std::vector<cv::Point2f>& corners, bool isForCalibration,
+                                        ChessboardStrategy* strategy) {
     // 准备灰度图像
     cv::Mat grayImage;
     if (image.channels() == 3) {
@@ -100,97 +112,143 @@ bool CameraCalibrator::detectChessboard(const cv::Mat& image, std::vector<cv::Po
     }
     
     bool found = false;
-    
-    // 方法1: 使用宽松的检测参数 - 最常用，成功率最高
     int relaxed_flags = cv::CALIB_CB_ADAPTIVE_THRESH | 
                        cv::CALIB_CB_NORMALIZE_IMAGE;
     
-    found = cv::findChessboardCorners(grayImage, boardSize, corners, relaxed_flags);
+    // 方法0: 由粗到精 - 在缩小的图像上检测，再回到全分辨率细化角点
+    bool boardLikely = true;
+    auto coarseStart = std::chrono::steady_clock::now();
+    found = detectChessboardCoarse(grayImage, corners, boardLikely);
+    if (grayImage.cols > kCoarseDetectionWidth) {
+        recordChessboardStrategy(ChessboardStrategy::Coarse, found,
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - coarseStart).count());
+    }
     
     if (isForCalibration) {
-        std::cout << "Method 1 - Relaxed detection (" << boardSize.width << "x" << boardSize.height << "): " 
-                  << (found ? "SUCCESS" : "FAILED") << std::endl;
-        if (found) {
-            std::cout << "Found " << corners.size() << " corners with relaxed flags" << std::endl;
-        }
+        std::cout << "Method 0 - Coarse-to-fine detection: " << (found ? "SUCCESS" : "FAILED")
+                  << (boardLikely ? "" : " (no board-like pattern at coarse scale)") << std::endl;
     }
     
-    // ✅ 如果第一次检测成功，立即进行亚像素精度优化并返回
     if (found) {
-        if (isForCalibration) {
-            std::cout << "✅ SUCCESS on first attempt - skipping other methods for efficiency" << std::endl;
+        if (strategy) {
+            *strategy = ChessboardStrategy::Coarse;
         }
-        // 亚像素精度优化
-        cv::cornerSubPix(grayImage, corners, cv::Size(5, 5), cv::Size(-1, -1),
-            cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.3));
         return true;
     }
     
-    // 方法2: 增强的预处理（仅在第一次失败时尝试）
-    cv::Mat enhancedImage = preprocessImage(image);
-    cv::Mat enhancedGray;
-    if (enhancedImage.channels() == 3) {
-        cv::cvtColor(enhancedImage, enhancedGray, cv::COLOR_BGR2GRAY);
-    } else {
-        enhancedGray = enhancedImage.clone();
+    // 粗检测认为画面中没有棋盘格：只做一次带快速检查的全分辨率检测（没有棋盘格时很快返回），
+    // 不再运行后面耗时的增强方法
+    if (!boardLikely) {
+        found = cv::findChessboardCorners(grayImage, boardSize, corners, relaxed_flags | cv::CALIB_CB_FAST_CHECK);
+        if (found) {
+            cv::cornerSubPix(grayImage, corners, cv::Size(5, 5), cv::Size(-1, -1),
+                cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.3));
+            if (strategy) {
+                *strategy = ChessboardStrategy::Relaxed;
+            }
+            return true;
+        }
+        if (strategy) {
+            *strategy = ChessboardStrategy::None;
+        }
+        if (isForCalibration) {
+            std::cout << "=== DETECTION FAILED (no chessboard in view) ===" << std::endl;
+        }
+        return false;
     }
     
-    found = cv::findChessboardCorners(enhancedGray, boardSize, corners, relaxed_flags);
-    
-    if (isForCalibration) {
-        std::cout << "Method 2 - Enhanced preprocessing: " << (found ? "SUCCESS" : "FAILED") << std::endl;
+    // 方法1-5: 全分辨率的回退策略，按本相机历史上的成功次数排序；
+    // 并行模式下各策略在独立线程上同时运行，第一个成功的策略立即返回结果
+    std::vector<ChessboardStrategy> strategies = getFallbackStrategyOrder(isForCalibration);
+    const cv::Size board = boardSize;
+    bool parallel = false;
+    {
+        // 上一次检测的后台策略尚未结束时按顺序执行，避免检测线程堆积、与去畸变争抢核心
+        std::lock_guard<std::mutex> lock(detectionMutex);
+        if (parallelDetection && runningStrategies == 0) {
+            runningStrategies = static_cast<int>(strategies.size());
+            parallel = true;
+        }
     }
     
-    if (found) {
-        cv::cornerSubPix(enhancedGray, corners, cv::Size(5, 5), cv::Size(-1, -1),
-            cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.3));
-        return true;
+    ChessboardStrategy winner = ChessboardStrategy::None;
+    if (parallel) {
+        // findChessboardCorners 无法中断：落选的策略在后台跑完并计入统计，
+        // 它们共享灰度图和结果的所有权，析构时等待它们结束
+        struct ParallelDetection {
+            std::mutex mutex;
+            std::condition_variable done;
+            int remaining = 0;
+            int winnerIndex = -1;
+            std::vector<cv::Point2f> corners;
+        };
+        auto state = std::make_shared<ParallelDetection>();
+        state->remaining = static_cast<int>(strategies.size());
+        for (size_t i = 0; i < strategies.size(); ++i) {
+            std::thread([this, state, grayImage, board, i, candidate = strategies[i]]() {
+                auto start = std::chrono::steady_clock::now();
+                std::vector<cv::Point2f> strategyCorners;
+                bool strategyFound = false;
+                try {
+                    strategyFound = runChessboardStrategy(candidate, grayImage, board, strategyCorners);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error in chessboard strategy " << chessboardStrategyName(candidate) << ": " << e.what() << std::endl;
+                }
+                bool won = false;
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (strategyFound && state->winnerIndex < 0) {
+                        state->winnerIndex = static_cast<int>(i);
+                        state->corners = std::move(strategyCorners);
+                        won = true;
+                    }
+                    state->remaining--;
+                    state->done.notify_all();
+                }
+                recordChessboardStrategy(candidate, won,
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                std::lock_guard<std::mutex> lock(detectionMutex);
+                if (--runningStrategies == 0) {
+                    strategiesFinished.notify_all();
+                }
+            }).detach();
+        }
+        
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state] { return state->winnerIndex >= 0 || state->remaining == 0; });
+        if (state->winnerIndex >= 0) {
+            winner = strategies[state->winnerIndex];
+            corners = state->corners;
+        }
+        if (isForCalibration) {
+            std::cout << "Methods 1-" << strategies.size() << " - Parallel fallback: "
+                      << (winner != ChessboardStrategy::None ? "SUCCESS (" + std::string(chessboardStrategyName(winner)) + ")" : "FAILED")
+                      << std::endl;
+        }
+    } else {
+        for (size_t i = 0; i < strategies.size() && winner == ChessboardStrategy::None; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            found = runChessboardStrategy(strategies[i], grayImage, board, corners);
+            recordChessboardStrategy(strategies[i], found,
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            if (isForCalibration) {
+                std::cout << "Method " << (i + 1) << " - " << chessboardStrategyName(strategies[i]) << ": "
+                          << (found ? "SUCCESS" : "FAILED") << std::endl;
+            }
+            if (found) {
+                winner = strategies[i];
+            }
+        }
     }
     
-    // 方法3: 无标志检测（最宽松）
-    found = cv::findChessboardCorners(grayImage, boardSize, corners, 0);
-    if (isForCalibration) {
-        std::cout << "Method 3 - No flags detection: " << (found ? "SUCCESS" : "FAILED") << std::endl;
+    if (strategy) {
+        *strategy = winner;
     }
-    
-    if (found) {
-        cv::cornerSubPix(grayImage, corners, cv::Size(5, 5), cv::Size(-1, -1),
-            cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.3));
+    if (winner != ChessboardStrategy::None) {
         return true;
     }
     
-    // 仅在标定模式下才执行更耗时的方法
     if (isForCalibration) {
-        // 方法4: 图像锐化
-        cv::Mat sharpened;
-        cv::Mat kernel = (cv::Mat_<float>(3,3) << 
-            0, -1, 0,
-            -1, 5, -1,
-            0, -1, 0);
-        cv::filter2D(grayImage, sharpened, grayImage.depth(), kernel);
-        
-        found = cv::findChessboardCorners(sharpened, boardSize, corners, relaxed_flags);
-        std::cout << "Method 4 - Enhanced (sharpened) image: " << (found ? "SUCCESS" : "FAILED") << std::endl;
-        
-        if (found) {
-            cv::cornerSubPix(sharpened, corners, cv::Size(5, 5), cv::Size(-1, -1),
-                cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.3));
-            return true;
-        }
-        
-        // 方法5: 对比度增强
-        cv::Mat contrast;
-        grayImage.convertTo(contrast, -1, 1.5, 0);
-        
-        found = cv::findChessboardCorners(contrast, boardSize, corners, relaxed_flags);
-        std::cout << "Method 5 - Contrast enhanced image: " << (found ? "SUCCESS" : "FAILED") << std::endl;
-        
-        if (found) {
-            cv::cornerSubPix(contrast, corners, cv::Size(5, 5), cv::Size(-1, -1),
-                cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.3));
-            return true;
-        }
-        
         std::cout << "=== DETECTION FAILED ===" << std::endl;
         std::cout << "Troubleshooting suggestions:" << std::endl;
         std::cout << "1. Check if chessboard has " << boardSize.width << "x" << boardSize.height << " internal corners" << std::endl;
@@ -202,6 +260,186 @@ bool CameraCalibrator::detectChessboard(const cv::Mat& image, std::vector<cv::Po
     return false;
 }
 
+bool CameraCalibrator::runChessboardStrategy(ChessboardStrategy strategy, const cv::Mat& grayImage, const cv::Size& board,
+                                             std::vector<cv::Point2f>& corners) {
+    int relaxed_flags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE;
+    int flags = relaxed_flags;
+    
+    // 准备该策略的输入图像
+    cv::Mat input;
+    switch (strategy) {
+        case ChessboardStrategy::Relaxed:
+            input = grayImage;
+            break;
+        case ChessboardStrategy::Enhanced: {
+            // 增强的预处理（直接在灰度图上完成）
+            input = preprocessGray(grayImage);
+            break;
+        }
+        case ChessboardStrategy::Strict:
+            // 无标志检测
+            input = grayImage;
+            flags = 0;
+            break;
+        case ChessboardStrategy::Sharpened: {
+            // 图像锐化
+            cv::Mat kernel = (cv::Mat_<float>(3,3) << 
+                0, -1, 0,
+                -1, 5, -1,
+                0, -1, 0);
+            cv::filter2D(grayImage, input, grayImage.depth(), kernel);
+            break;
+        }
+        case ChessboardStrategy::Contrast:
+            // 对比度增强
+            grayImage.convertTo(input, -1, 1.5, 0);
+            break;
+        default:
+            return false;
+    }
+    
+    if (!cv::findChessboardCorners(input, board, corners, flags)) {
+        return false;
+    }
+    
+    // 亚像素精度优化
+    cv::cornerSubPix(input, corners, cv::Size(5, 5), cv::Size(-1, -1),
+        cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 0.3));
+    return true;
+}
+
+std::vector<CameraCalibrator::ChessboardStrategy> CameraCalibrator::getFallbackStrategyOrder(bool includeSlow) const {
+    std::vector<ChessboardStrategy> order = {ChessboardStrategy::Relaxed, ChessboardStrategy::Enhanced, ChessboardStrategy::Strict};
+    // 锐化和对比度增强较耗时，仅在标定采集时使用
+    if (includeSlow) {
+        order.push_back(ChessboardStrategy::Sharpened);
+        order.push_back(ChessboardStrategy::Contrast);
+    }
+    
+    // 在本相机上成功次数多的策略排在前面；次数相同时保持默认顺序
+    std::lock_guard<std::mutex> lock(detectionMutex);
+    std::stable_sort(order.begin(), order.end(), [this](ChessboardStrategy a, ChessboardStrategy b) {
+        return strategyCounters[static_cast<int>(a)].wins > strategyCounters[static_cast<int>(b)].wins;
+    });
+    return order;
+}
+
+void CameraCalibrator::recordChessboardStrategy(ChessboardStrategy strategy, bool found, double elapsedMs) {
+    std::lock_guard<std::mutex> lock(detectionMutex);
+    StrategyCounters& counters = strategyCounters[static_cast<int>(strategy)];
+    counters.attempts++;
+    counters.totalMs += elapsedMs;
+    if (found) {
+        counters.wins++;
+    }
+}
+
+const char* CameraCalibrator::chessboardStrategyName(ChessboardStrategy strategy) {
+    switch (strategy) {
+        case ChessboardStrategy::Coarse: return "coarse";
+        case ChessboardStrategy::Relaxed: return "relaxed";
+        case ChessboardStrategy::Enhanced: return "enhanced";
+        case ChessboardStrategy::Strict: return "strict";
+        case ChessboardStrategy::Sharpened: return "sharpened";
+        case ChessboardStrategy::Contrast: return "contrast";
+        default: return "none";
+    }
+}
+
+std::vector<CameraCalibrator::ChessboardStrategyStats> CameraCalibrator::getChessboardStrategyStats() const {
+    std::lock_guard<std::mutex> lock(detectionMutex);
+    std::vector<ChessboardStrategyStats> stats;
+    for (int i = 0; i < kChessboardStrategyCount; ++i) {
+        const StrategyCounters& counters = strategyCounters[i];
+        ChessboardStrategyStats entry;
+        entry.name = chessboardStrategyName(static_cast<ChessboardStrategy>(i));
+        entry.attempts = counters.attempts;
+        entry.wins = counters.wins;
+        entry.averageMs = counters.attempts > 0 ? counters.totalMs / counters.attempts : 0.0;
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+void CameraCalibrator::setParallelDetectionEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(detectionMutex);
+    parallelDetection = enabled;
+    std::cout << "🧵 [CHESSBOARD] Parallel fallback detection: " << (enabled ? "ON" : "OFF") << std::endl;
+}
+
+bool CameraCalibrator::isParallelDetectionEnabled() const {
+    std::lock_guard<std::mutex> lock(detectionMutex);
+    return parallelDetection;
+}
+
+bool CameraCalibrator::detectChessboardCoarse(const cv::Mat& grayImage, std::vector<cv::Point2f>& corners, bool& boardLikely) {
+    boardLikely = true;
+    if (grayImage.cols <= kCoarseDetectionWidth) {
+        return false;  // 图像本身已经足够小，直接使用全分辨率检测
+    }
+    
+    cv::Mat coarse;
+    int coarseHeight = std::max(1, grayImage.rows * kCoarseDetectionWidth / grayImage.cols);
+    cv::resize(grayImage, coarse, cv::Size(kCoarseDetectionWidth, coarseHeight), 0, 0, cv::INTER_AREA);
+    
+    // checkChessboard 只做几毫秒的形态学判断，用来决定是否值得运行后面耗时的检测
+    boardLikely = cv::checkChessboard(coarse, boardSize);
+    if (!boardLikely) {
+        return false;
+    }
+    
+    if (!cv::findChessboardCorners(coarse, boardSize, corners,
+                                   cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE)) {
+        return false;
+    }
+    
+    // 角点换算回全分辨率坐标（按像素中心对齐）
+    float scaleX = static_cast<float>(grayImage.cols) / coarse.cols;
+    float scaleY = static_cast<float>(grayImage.rows) / coarse.rows;
+    for (auto& corner : corners) {
+        corner.x = (corner.x + 0.5f) * scaleX - 0.5f;
+        corner.y = (corner.y + 0.5f) * scaleY - 0.5f;
+    }
+    
+    // 粗检测的定位误差约为一个缩放倍数的像素，细化窗口需要覆盖这个误差
+    int searchRadius = static_cast<int>(std::ceil(std::max(scaleX, scaleY))) + 2;
+    refineCornersInRoi(grayImage, corners, searchRadius);
+    return true;
+}
+
+void CameraCalibrator::refineCornersInRoi(const cv::Mat& grayImage, std::vector<cv::Point2f>& corners, int searchRadius) {
+    // 窗口不能超过相邻角点间距的一半，否则会收敛到相邻方格的角点上
+    float minSpacing = std::numeric_limits<float>::max();
+    for (int row = 0; row < boardSize.height; ++row) {
+        for (int col = 0; col < boardSize.width; ++col) {
+            const cv::Point2f& corner = corners[row * boardSize.width + col];
+            if (col + 1 < boardSize.width) {
+                minSpacing = std::min(minSpacing, static_cast<float>(cv::norm(corners[row * boardSize.width + col + 1] - corner)));
+            }
+            if (row + 1 < boardSize.height) {
+                minSpacing = std::min(minSpacing, static_cast<float>(cv::norm(corners[(row + 1) * boardSize.width + col] - corner)));
+            }
+        }
+    }
+    int halfWindow = std::max(2, std::min(searchRadius, static_cast<int>(minSpacing * 0.4f)));
+    
+    // 只取棋盘格所在区域（加上细化窗口的边距）的视图，不复制像素
+    cv::Rect roi = cv::boundingRect(corners);
+    int margin = halfWindow + 2;
+    roi = cv::Rect(roi.x - margin, roi.y - margin, roi.width + 2 * margin, roi.height + 2 * margin) &
+          cv::Rect(0, 0, grayImage.cols, grayImage.rows);
+    
+    cv::Point2f offset(static_cast<float>(roi.x), static_cast<float>(roi.y));
+    for (auto& corner : corners) {
+        corner -= offset;
+    }
+    cv::cornerSubPix(grayImage(roi), corners, cv::Size(halfWindow, halfWindow), cv::Size(-1, -1),
+        cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.01));
+    for (auto& corner : corners) {
+        corner += offset;
+    }
+}
+
 bool CameraCalibrator::addCalibrationImage(const cv::Mat& image) {
     std::cout << "\n=== CameraCalibrator::addCalibrationImage() START ===" << std::endl;
     std::cout << "Current session image count before adding: " << imagePoints.size() << std::endl;
@@ -220,8 +458,8 @@ bool CameraCalibrator::addCalibrationImage(const cv::Mat& image) {
     
     std::cout << "Image type: " << image.type() << " (CV_8UC3=" << CV_8UC3 << ", CV_8UC1=" << CV_8UC1 << ")" << std::endl;
     
-    // 1. 图像预处理
-    cv::Mat processedImage = preprocessImage(image);
+    // 1. 图像预处理（单通道灰度，后续检测、细化和质量评估都直接使用）
+    cv::Mat processedImage = preprocessGray(image);
     std::cout << "Image preprocessing completed" << std::endl;
     
     // 2. 检测棋盘格角点
@@ -242,14 +480,7 @@ bool CameraCalibrator::addCalibrationImage(const cv::Mat& image) {
     std::cout << "Found " << corners.size() << " corners (expected: " << (boardSize.width * boardSize.height) << ")" << std::endl;
     
     // 3. 亚像素精度优化
-    cv::Mat gray;
-    if (processedImage.channels() == 3) {
-        cv::cvtColor(processedImage, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = processedImage.clone();
-    }
-    
-    cv::cornerSubPix(gray, corners, cv::Size(11, 11), cv::Size(-1, -1), 
+    cv::cornerSubPix(processedImage, corners, cv::Size(11, 11), cv::Size(-1, -1), 
                     cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.01));
     std::cout << "Corner subpixel refinement completed" << std::endl;
     
@@ -367,39 +598,32 @@ bool CameraCalibrator::addCalibrationImage(const cv::Mat& image) {
     
     std::cout << "Total valid calibration images now: " << imagePoints.size() << std::endl;
     
-    // 6. 保存高质量标定图像到磁盘
+    // 6. 保存高质量标定图像到磁盘：交给后台写入线程，绘制、编码和写盘都不占用采集线程
     if (saveCalibrationImages) {
-        std::cout << "Saving calibration image to disk..." << std::endl;
-        
-        // 确保目录存在
-        std::string dirCmd = "mkdir -p calibration_images";
-        int dirResult = system(dirCmd.c_str());
-        
-        std::string filename = "calibration_images/calib_" + 
-                             std::to_string(nextImageNumber) + ".jpg";
-        
-        // 在图像上绘制检测到的角点
-        cv::Mat imageWithCorners = image.clone();
-        cv::drawChessboardCorners(imageWithCorners, boardSize, corners, found);
-        
-        // 添加质量信息到图像上
-        std::string qualityText = metrics.qualityLevel + " (Sharp:" + 
-                                std::to_string(int(metrics.sharpness)) + 
-                                " Conf:" + std::to_string(int(metrics.cornerConfidence * 100)) + "%)";
-        cv::putText(imageWithCorners, qualityText, cv::Point(10, 30), 
-                   cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(226, 43, 138), 2); // 紫色 (138, 43, 226) 表示成功
+        CalibrationImageJob job;
+        job.path = "calibration_images/calib_" + std::to_string(nextImageNumber) + ".jpg";
+        job.image = image;
+        job.boardSize = boardSize;
+        job.corners = corners;
+        job.caption = metrics.qualityLevel + " (Sharp:" + 
+                      std::to_string(int(metrics.sharpness)) + 
+                      " Conf:" + std::to_string(int(metrics.cornerConfidence * 100)) + "%)";
         
-        // 保存图像
-        std::cout << "Trying to save image to: " << filename << std::endl;
-        bool writeSuccess = cv::imwrite(filename, imageWithCorners);
-        if (writeSuccess) {
-            std::cout << "✅ Successfully saved calibration image: " << filename << std::endl;
-            nextImageNumber++; // 保存成功后递增编号
-        } else {
-            std::cerr << "❌ Failed to save calibration image: " << filename << std::endl;
-            std::cout << "=== CameraCalibrator::addCalibrationImage() END (SAVE FAILED) ===" << std::endl;
-            return false;
+        std::cout << "Queueing calibration image for saving: " << job.path << std::endl;
+        const std::string queuedPath = job.path;
+        std::string droppedPath;
+        if (!imageWriter.enqueue(std::move(job), &droppedPath)) {
+            // 角点数据已加入标定，只是有一张图像不会保存到磁盘
+            std::cerr << "⚠️ Calibration image writer is backed up, " << droppedPath << " not saved" << std::endl;
+        }
+        // 新图像被丢弃时编号留给下一张，磁盘上的编号保持连续；丢弃的是更早排队的图像时，上面已记录缺失的编号
+        if (droppedPath != queuedPath) {
+            nextImageNumber++;
         }
+        
+        CalibrationImageWriter::Stats writerStats = imageWriter.getStats();
+        std::cout << "Image writer: queue " << writerStats.queueDepth << "/" << writerStats.capacity
+                  << ", avg write " << writerStats.averageWriteMs << "ms, dropped " << writerStats.dropped << std::endl;
     } else {
         std::cout << "Image saving is disabled (saveCalibrationImages = false)" << std::endl;
     }
@@ -505,10 +729,12 @@ bool CameraCalibrator::calibrate() {
     // 5. 执行标定
     std::cout << "Starting camera calibration..." << std::endl;
     try {
+        cv::Mat newCameraMatrix, newDistCoeffs;
         totalError = cv::calibrateCamera(objectPoints, imagePoints, 
                                        imageSize, 
-                                       cameraMatrix, distCoeffs, 
+                                       newCameraMatrix, newDistCoeffs, 
                                        rvecs, tvecs, flags);
+        setCalibrationMatrices(newCameraMatrix, newDistCoeffs);
         calibrated = true;
         
         // 6. 计算详细的重投影误差统计
@@ -627,8 +853,9 @@ bool CameraCalibrator::loadCalibrationData(const std::string& filename) {
         return false;
     }
     
-    fs["camera_matrix"] >> cameraMatrix;
-    fs["dist_coeffs"] >> distCoeffs;
+    cv::Mat loadedCameraMatrix, loadedDistCoeffs;
+    fs["camera_matrix"] >> loadedCameraMatrix;
+    fs["dist_coeffs"] >> loadedDistCoeffs;
     fs["board_width"] >> boardSize.width;
     fs["board_height"] >> boardSize.height;
     fs["square_size"] >> squareSize;
@@ -636,66 +863,87 @@ bool CameraCalibrator::loadCalibrationData(const std::string& filename) {
     
     // 添加调试信息
     std::cout << "📊 [CALIBRATION LOAD] Loaded calibration data:" << std::endl;
-    std::cout << "  📐 Camera Matrix: " << cameraMatrix.rows << "x" << cameraMatrix.cols << ", type: " << cameraMatrix.type() << std::endl;
-    std::cout << "  🔧 Distortion Coeffs: " << distCoeffs.rows << "x" << distCoeffs.cols << ", type: " << distCoeffs.type() << std::endl;
+    std::cout << "  📐 Camera Matrix: " << loadedCameraMatrix.rows << "x" << loadedCameraMatrix.cols << ", type: " << loadedCameraMatrix.type() << std::endl;
+    std::cout << "  🔧 Distortion Coeffs: " << loadedDistCoeffs.rows << "x" << loadedDistCoeffs.cols << ", type: " << loadedDistCoeffs.type() << std::endl;
     std::cout << "  📏 Board Size: " << boardSize.width << "x" << boardSize.height << std::endl;
     std::cout << "  📐 Square Size: " << squareSize << "m" << std::endl;
     std::cout << "  📊 Reprojection Error: " << totalError << " pixels" << std::endl;
     
     // 验证加载的数据
-    if (cameraMatrix.empty() || distCoeffs.empty()) {
+    if (loadedCameraMatrix.empty() || loadedDistCoeffs.empty()) {
         std::cerr << "❌ [CALIBRATION LOAD] Empty matrices loaded" << std::endl;
         return false;
     }
     
+    setCalibrationMatrices(loadedCameraMatrix, loadedDistCoeffs);
     calibrated = true;
     fs.release();
     return true;
 }
 
+// 按水平行带并行 remap：每个行带只写输出的对应行，映射表中是源图像的绝对坐标，因此各行带互不依赖
+// 行带数取线程数的2倍以平衡负载，行带高度按8行对齐；图像太小时单次 remap 更快
+static void remapInBands(const cv::Mat& src, cv::Mat& dst, const cv::Mat& map1, const cv::Mat& map2, ThreadPool* pool) {
+    const int minRowsPerBand = 32;
+    int bandCount = pool ? std::min(pool->threadCount() * 2, dst.rows / minRowsPerBand) : 1;
+    if (bandCount <= 1) {
+        cv::remap(src, dst, map1, map2, cv::INTER_LINEAR);
+        return;
+    }
+    
+    int bandRows = ((dst.rows + bandCount - 1) / bandCount + 7) & ~7;
+    bandCount = (dst.rows + bandRows - 1) / bandRows;
+    pool->parallelFor(bandCount, [&](int band) {
+        int y0 = band * bandRows;
+        int y1 = std::min(dst.rows, y0 + bandRows);
+        cv::Mat dstBand = dst.rowRange(y0, y1);
+        cv::remap(src, dstBand, map1.rowRange(y0, y1), map2.rowRange(y0, y1), cv::INTER_LINEAR);
+    });
+}
+
 cv::Mat CameraCalibrator::undistortImage(const cv::Mat& image) {
+    return undistortImage(image, image.size());
+}
+
+cv::Mat CameraCalibrator::undistortImage(const cv::Mat& image, const cv::Size& outputSize) {
     // 快速验证输入
     if (image.empty()) {
         std::cerr << "❌ [UNDISTORT] Input image is empty" << std::endl;
         return cv::Mat();
     }
     
-    // 快速验证标定状态
-    if (!calibrated) {
+    // 在锁内取得标定矩阵的快照，之后的验证和映射表生成都使用这一份，不受并发重新标定的影响
+    cv::Mat K, D;
+    uint64_t version = 0;
+    if (!getCalibrationSnapshot(K, D, version)) {
         std::cerr << "❌ [UNDISTORT] Camera not calibrated" << std::endl;
         return cv::Mat();
     }
     
     // 快速验证矩阵有效性
-    if (cameraMatrix.empty() || cameraMatrix.rows != 3 || cameraMatrix.cols != 3) {
+    if (K.empty() || K.rows != 3 || K.cols != 3) {
         std::cerr << "❌ [UNDISTORT] Invalid camera matrix" << std::endl;
         return cv::Mat();
     }
     
-    // 修复：更灵活的畸变系数验证
-    if (distCoeffs.empty()) {
-        std::cerr << "❌ [UNDISTORT] Empty distortion coefficients" << std::endl;
-        return cv::Mat();
-    }
-    
     // OpenCV支持不同数量的畸变系数：4, 5, 8, 12, 14
-    int distCoeffCount = distCoeffs.rows * distCoeffs.cols;
+    int distCoeffCount = D.rows * D.cols;
     if (distCoeffCount < 4) {
         std::cerr << "❌ [UNDISTORT] Invalid distortion coefficients count: " << distCoeffCount << " (minimum 4)" << std::endl;
-        std::cerr << "  📐 Distortion shape: " << distCoeffs.rows << "x" << distCoeffs.cols << std::endl;
+        std::cerr << "  📐 Distortion shape: " << D.rows << "x" << D.cols << std::endl;
         return cv::Mat();
     }
     
             // 移除重复的调试信息 - 已经验证有效
     
     // 验证矩阵数据类型
-    if (cameraMatrix.type() != CV_64F && cameraMatrix.type() != CV_32F) {
-        std::cerr << "❌ [UNDISTORT] Invalid camera matrix type: " << cameraMatrix.type() << std::endl;
+    if (K.type() != CV_64F && K.type() != CV_32F) {
+        std::cerr << "❌ [UNDISTORT] Invalid camera matrix type: " << K.type() << std::endl;
         return cv::Mat();
     }
     
-    if (distCoeffs.type() != CV_64F && distCoeffs.type() != CV_32F) {
-        std::cerr << "❌ [UNDISTORT] Invalid distortion coefficients type: " << distCoeffs.type() << std::endl;
+    if (D.type() != CV_64F && D.type() != CV_32F) {
+        std::cerr << "❌ [UNDISTORT] Invalid distortion coefficients type: " << D.type() << std::endl;
         return cv::Mat();
     }
     
@@ -710,49 +958,23 @@ cv::Mat CameraCalibrator::undistortImage(const cv::Mat& image) {
         return cv::Mat();
     }
     
+    if (outputSize.width <= 0 || outputSize.height <= 0) {
+        std::cerr << "❌ [UNDISTORT] Invalid output dimensions: " << outputSize.width << "x" << outputSize.height << std::endl;
+        return cv::Mat();
+    }
+    
     try {
-        // 性能优化：使用静态变量缓存undistort映射表
-        static cv::Mat cachedMap1, cachedMap2;
-        static cv::Size cachedSize(-1, -1);
-        static cv::Mat cachedCameraMatrix, cachedDistCoeffs;
-        static bool mapsInitialized = false;
-        
-        cv::Size currentSize(image.cols, image.rows);
-        
-        // 检查是否需要重新初始化映射表
-        bool needReinitialize = false;
-        if (!mapsInitialized || 
-            cachedSize != currentSize ||
-            !isMatrixEqual(cachedCameraMatrix, cameraMatrix) ||
-            !isMatrixEqual(cachedDistCoeffs, distCoeffs)) {
-            needReinitialize = true;
-        }
-        
-        if (needReinitialize) {
-            auto initStart = std::chrono::high_resolution_clock::now();
-            
-            // 计算undistort映射表（这是最耗时的操作，但只需要计算一次）
-            cv::initUndistortRectifyMap(
-                cameraMatrix, distCoeffs, cv::Mat(),
-                cameraMatrix, currentSize, CV_16SC2,
-                cachedMap1, cachedMap2
-            );
-            
-            // 更新缓存
-            cachedSize = currentSize;
-            cachedCameraMatrix = cameraMatrix.clone();
-            cachedDistCoeffs = distCoeffs.clone();
-            mapsInitialized = true;
-            
-            auto initEnd = std::chrono::high_resolution_clock::now();
-            double initTime = std::chrono::duration<double, std::milli>(initEnd - initStart).count();
-            
-            std::cout << "📊 [UNDISTORT] Map initialization time: " << initTime << "ms" << std::endl;
+        // 执行快速重映射，输出缓冲区从帧缓冲池取得
+        // 缩小倍数不超过2时双线性插值与先校正再缩放的结果几乎一致
+        // 多个线程可以同时使用同一份映射表
+        std::shared_ptr<const UndistortMaps> maps = getUndistortMaps(image.size(), outputSize, K, D, version);
+        std::shared_ptr<ThreadPool> pool;
+        {
+            std::lock_guard<std::mutex> lock(undistortMapMutex);
+            pool = undistortPool;
         }
-        
-        // 执行快速重映射
-        cv::Mat undistortedImage;
-        cv::remap(image, undistortedImage, cachedMap1, cachedMap2, cv::INTER_LINEAR);
+        cv::Mat undistortedImage = FramePool::instance().acquire(outputSize, image.type());
+        remapInBands(image, undistortedImage, maps->map1, maps->map2, pool.get());
         
         return undistortedImage;
         
@@ -768,6 +990,178 @@ cv::Mat CameraCalibrator::undistortImage(const cv::Mat& image) {
     }
 }
 
+// 最多缓存的映射表数量（1080p 每份约 12MB）
+static const size_t kMaxUndistortMaps = 6;
+
+std::shared_ptr<const CameraCalibrator::UndistortMaps> CameraCalibrator::findUndistortMapsLocked(const cv::Size& inputSize, const cv::Size& outputSize, uint64_t version) {
+    // 标定版本相同即可复用，无需逐元素比较矩阵；命中的映射表移到末尾（最近使用）
+    for (auto it = undistortMaps.begin(); it != undistortMaps.end(); ++it) {
+        if ((*it)->inputSize == inputSize && (*it)->outputSize == outputSize &&
+            (*it)->calibrationVersion == version) {
+            std::rotate(it, it + 1, undistortMaps.end());
+            return undistortMaps.back();
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const CameraCalibrator::UndistortMaps> CameraCalibrator::getUndistortMaps(const cv::Size& inputSize, const cv::Size& outputSize,
+                                                                                           const cv::Mat& K, const cv::Mat& D, uint64_t version) {
+    {
+        std::lock_guard<std::mutex> lock(undistortMapMutex);
+        if (auto cached = findUndistortMapsLocked(inputSize, outputSize, version)) {
+            return cached;
+        }
+    }
+    
+    // 映射表在锁外生成（1080p 需要几十毫秒），期间其他尺寸的查询和标定矩阵的替换不被阻塞
+    auto initStart = std::chrono::high_resolution_clock::now();
+    
+    // 缩放合并进新的相机矩阵：输出像素 (u', v') 按缩放后的内参反投影，再按原内参和畸变投影回输入图像
+    // 像素中心对齐：c' = (c + 0.5) * s - 0.5
+    double sx = static_cast<double>(outputSize.width) / inputSize.width;
+    double sy = static_cast<double>(outputSize.height) / inputSize.height;
+    cv::Mat scaledCameraMatrix;
+    K.convertTo(scaledCameraMatrix, CV_64F);
+    scaledCameraMatrix.at<double>(0, 0) *= sx;
+    scaledCameraMatrix.at<double>(0, 2) = (scaledCameraMatrix.at<double>(0, 2) + 0.5) * sx - 0.5;
+    scaledCameraMatrix.at<double>(1, 1) *= sy;
+    scaledCameraMatrix.at<double>(1, 2) = (scaledCameraMatrix.at<double>(1, 2) + 0.5) * sy - 0.5;
+    
+    auto maps = std::make_shared<UndistortMaps>();
+    maps->inputSize = inputSize;
+    maps->outputSize = outputSize;
+    maps->calibrationVersion = version;
+    
+    // 计算undistort映射表（这是最耗时的操作，但每种尺寸只需要计算一次）
+    cv::initUndistortRectifyMap(
+        K, D, cv::Mat(),
+        scaledCameraMatrix, outputSize, CV_16SC2,
+        maps->map1, maps->map2
+    );
+    
+    auto initEnd = std::chrono::high_resolution_clock::now();
+    double initTime = std::chrono::duration<double, std::milli>(initEnd - initStart).count();
+    
+    std::cout << "📊 [UNDISTORT] Map initialization time: " << initTime << "ms ("
+              << inputSize.width << "x" << inputSize.height << " -> "
+              << outputSize.width << "x" << outputSize.height << ")" << std::endl;
+    
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    // 其他线程可能同时生成了同一份映射表，使用先入缓存的那份
+    if (auto cached = findUndistortMapsLocked(inputSize, outputSize, version)) {
+        return cached;
+    }
+    // 生成期间标定已更新：本次调用仍使用按快照生成的映射表，但不放入缓存
+    if (version != calibrationVersion) {
+        return maps;
+    }
+    
+    // 超出容量时淘汰最久未使用的映射表（切换分辨率时旧分辨率的映射表仍保留一段时间）
+    if (undistortMaps.size() >= kMaxUndistortMaps) {
+        undistortMaps.erase(undistortMaps.begin());
+    }
+    undistortMaps.push_back(maps);
+    return maps;
+}
+
+void CameraCalibrator::setCalibrationMatrices(const cv::Mat& newCameraMatrix, const cv::Mat& newDistCoeffs) {
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    cameraMatrix = newCameraMatrix;
+    distCoeffs = newDistCoeffs;
+    calibrationVersion++;
+    undistortMaps.clear();  // 正在使用旧映射表的线程仍持有自己的引用
+}
+
+cv::Mat CameraCalibrator::getCameraMatrix() const {
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    return cameraMatrix;
+}
+
+cv::Mat CameraCalibrator::getDistCoeffs() const {
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    return distCoeffs;
+}
+
+bool CameraCalibrator::getCalibrationSnapshot(cv::Mat& cameraMatrixOut, cv::Mat& distCoeffsOut) const {
+    // 标定矩阵替换时整体赋值新的 Mat，持有旧引用的读者不受影响
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    cameraMatrixOut = cameraMatrix;
+    distCoeffsOut = distCoeffs;
+    return calibrated && !cameraMatrixOut.empty() && !distCoeffsOut.empty();
+}
+
+bool CameraCalibrator::getCalibrationSnapshot(cv::Mat& cameraMatrixOut, cv::Mat& distCoeffsOut, uint64_t& version) const {
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    cameraMatrixOut = cameraMatrix;
+    distCoeffsOut = distCoeffs;
+    version = calibrationVersion;
+    return calibrated && !cameraMatrixOut.empty() && !distCoeffsOut.empty();
+}
+
+cv::Point2f CameraCalibrator::undistortPoint(const cv::Point2f& point) {
+    cv::Mat K, D;
+    if (!getCalibrationSnapshot(K, D)) {
+        return point;
+    }
+    
+    try {
+        // P = K：结果为无畸变图像中的像素坐标，与 undistortImage() 的输出一致
+        std::vector<cv::Point2f> points{point};
+        cv::undistortPoints(points, points, K, D, cv::noArray(), K);
+        return points[0];
+    } catch (const cv::Exception& e) {
+        std::cerr << "❌ [UNDISTORT] Point undistortion failed: " << e.what() << std::endl;
+        return point;
+    }
+}
+
+cv::Point2f CameraCalibrator::distortPoint(const cv::Point2f& point) {
+    cv::Mat K, D;
+    if (!getCalibrationSnapshot(K, D)) {
+        return point;
+    }
+    
+    try {
+        // 反投影到归一化平面，再带畸变投影回原始图像
+        cv::Mat K64;
+        K.convertTo(K64, CV_64F);
+        double x = (point.x - K64.at<double>(0, 2)) / K64.at<double>(0, 0);
+        double y = (point.y - K64.at<double>(1, 2)) / K64.at<double>(1, 1);
+        std::vector<cv::Point3f> objectPoints{cv::Point3f(static_cast<float>(x), static_cast<float>(y), 1.0f)};
+        std::vector<cv::Point2f> imagePoints;
+        cv::Mat zeroVector = cv::Mat::zeros(3, 1, CV_64F);  // 无旋转、无平移
+        cv::projectPoints(objectPoints, zeroVector, zeroVector, K, D, imagePoints);
+        return imagePoints[0];
+    } catch (const cv::Exception& e) {
+        std::cerr << "❌ [UNDISTORT] Point distortion failed: " << e.what() << std::endl;
+        return point;
+    }
+}
+
+void CameraCalibrator::setUndistortThreadCount(int count) {
+    // 新线程池在锁外创建；正在使用旧线程池的 remap 持有自己的引用，完成后旧线程池才销毁
+    std::shared_ptr<ThreadPool> pool = count > 1 ? std::make_shared<ThreadPool>(count) : nullptr;
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    undistortPool = std::move(pool);
+    std::cout << "🧵 [UNDISTORT] Thread count: " << std::max(1, count) << std::endl;
+}
+
+int CameraCalibrator::getUndistortThreadCount() const {
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    return undistortPool ? undistortPool->threadCount() : 1;
+}
+
+void CameraCalibrator::retainUndistortMaps(const std::vector<cv::Size>& outputSizes) {
+    std::lock_guard<std::mutex> lock(undistortMapMutex);
+    undistortMaps.erase(std::remove_if(undistortMaps.begin(), undistortMaps.end(),
+                                       [&outputSizes](const std::shared_ptr<const UndistortMaps>& maps) {
+                                           return std::find(outputSizes.begin(), outputSizes.end(),
+                                                            maps->outputSize) == outputSizes.end();
+                                       }),
+                        undistortMaps.end());
+}
+
 // 图像质量评估实现
 CameraCalibrator::ImageQualityMetrics CameraCalibrator::evaluateImageQuality(
     const cv::Mat& image, const std::vector<cv::Point2f>& corners) {
@@ -775,27 +1169,18 @@ CameraCalibrator::ImageQualityMetrics CameraCalibrator::evaluateImageQuality(
     ImageQualityMetrics metrics;
     cv::Mat grayImage;
     
-    // 转换为灰度图
+    // 转换为灰度图（只读，灰度输入无需复制）
     if (image.channels() == 3) {
         cv::cvtColor(image, grayImage, cv::COLOR_BGR2GRAY);
     } else {
-        grayImage = image.clone();
+        grayImage = image;
     }
     
-    // 1. 清晰度评估（拉普拉斯方差）
-    cv::Mat laplacian;
-    cv::Laplacian(grayImage, laplacian, CV_64F);
-    cv::Scalar mean, stddev;
-    cv::meanStdDev(laplacian, mean, stddev);
-    metrics.sharpness = stddev.val[0] * stddev.val[0];  // 方差作为清晰度指标
-    
-    // 2. 亮度评估
-    cv::Scalar meanBrightness = cv::mean(grayImage);
-    metrics.brightness = meanBrightness.val[0];
-    
-    // 3. 对比度评估
-    cv::meanStdDev(grayImage, mean, stddev);
-    metrics.contrast = stddev.val[0];
+    // 1-3. 清晰度（拉普拉斯方差）、亮度和对比度在一遍扫描中算出
+    GrayImageStats grayStats = computeGrayImageStats(grayImage);
+    metrics.sharpness = grayStats.laplacianVariance;  // 方差作为清晰度指标
+    metrics.brightness = grayStats.mean;
+    metrics.contrast = grayStats.stddev;
     
     // 4. 角点检测置信度（基于角点分布的均匀性）
     if (!corners.empty()) {
@@ -1040,6 +1425,64 @@ bool CameraCalibrator::shouldAcceptImage(const ImageQualityMetrics& metrics) {
     return true;
 }
 
+cv::Mat CameraCalibrator::preprocessGray(const cv::Mat& image) {
+    // 与 preprocessImage 相同的增强策略，但所有步骤都在一个 8 位通道上完成，不经过 Lab 转换和三通道滤波
+    // 伽马校正与 α/β 线性调整合并为一张查找表：末尾的最小-最大归一化会抵消任何线性缩放，
+    // 因此 α/β 只通过饱和截断起作用，提前到滤波之前与伽马一起查表，结果与原顺序近似
+    static const cv::Mat pointLut = [] {
+        const double gamma = 0.7;              // 经验值：0.6-0.8适合低光照场景
+        const double alpha = 1.2, beta = 10.0; // 轻微增强对比度、小幅提升整体亮度
+        cv::Mat lut(1, 256, CV_8U);
+        uchar* p = lut.ptr();
+        for (int i = 0; i < 256; ++i) {
+            p[i] = cv::saturate_cast<uchar>(std::pow(i / 255.0, gamma) * 255.0 * alpha + beta);
+        }
+        return lut;
+    }();
+    
+    cv::Mat gray;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+    
+    std::lock_guard<std::mutex> lock(preprocessMutex);
+    
+    // 第1级：局部对比度增强（CLAHE），参数与 preprocessImage 相同
+    if (!preprocessClahe) {
+        preprocessClahe = cv::createCLAHE(3.0, cv::Size(8, 8));
+    }
+    preprocessClahe->apply(gray, preprocessScratch);
+    
+    // 第2级：伽马 + α/β（一次查表，原地完成）
+    cv::LUT(preprocessScratch, pointLut, preprocessScratch);
+    
+    // 第3级：双边滤波去噪（不能原地执行，写入第二个缓冲区）
+    cv::Mat* current = &preprocessScratch;
+    if (blurKernelSize > 0) {
+        cv::bilateralFilter(preprocessScratch, preprocessDenoised,
+                           blurKernelSize, blurKernelSize * 2, blurKernelSize / 2);
+        current = &preprocessDenoised;
+    }
+    
+    // 第4级：拉普拉斯锐化，严格/平衡模式启用
+    if (qualityCheckLevel == STRICT || qualityCheckLevel == BALANCED) {
+        static const cv::Mat kernel = (cv::Mat_<float>(3,3) << 
+                                      0, -1, 0,
+                                      -1, 5, -1,
+                                      0, -1, 0);
+        cv::Mat* target = current == &preprocessScratch ? &preprocessDenoised : &preprocessScratch;
+        cv::filter2D(*current, *target, -1, kernel);
+        current = target;
+    }
+    
+    // 第5级：最小-最大归一化，输出新分配的图像（缓冲区留给下一次调用）
+    cv::Mat result;
+    cv::normalize(*current, result, 0, 255, cv::NORM_MINMAX, CV_8UC1);
+    return result;
+}
+
 cv::Mat CameraCalibrator::preprocessImage(const cv::Mat& image) {
     cv::Mat processed = image.clone();
     
@@ -1208,10 +1651,3 @@ void CameraCalibrator::filterCalibrationImages() {
     
     std::cout << "Filtered result: " << imagePoints.size() << " valid images remaining" << std::endl;
 }
-
-bool CameraCalibrator::isMatrixEqual(const cv::Mat& mat1, const cv::Mat& mat2) {
-    if (mat1.size() != mat2.size() || mat1.type() != mat2.type()) {
-        return false;
-    }
-    return cv::countNonZero(mat1 != mat2) == 0;
-}
@@ -0,0 +1,476 @@
+#include "../include/CaptureBackend.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+std::unique_ptr<CaptureBackend> CaptureBackend::create(CaptureBackendType type) {
+    switch (type) {
+        case CaptureBackendType::V4L2Mmap:
+            return std::unique_ptr<CaptureBackend>(new V4L2MmapCapture());
+        case CaptureBackendType::FakeFile:
+            return std::unique_ptr<CaptureBackend>(new FakeFileCapture());
+        default:
+            return nullptr;  // OpenCV 后端由 VideoStreamer 直接使用 cv::VideoCapture
+    }
+}
+
+// ==================== 缓冲区视图 ====================
+
+// 视图分配器：不分配内存，只在最后一个引用释放时把缓冲区还给所属的环
+class CaptureBufferAllocator : public cv::MatAllocator {
+public:
+    struct BufferRef {
+        std::shared_ptr<CaptureBufferRing> ring;  // 持有环，保证映射在视图释放前一直有效
+        int index;
+    };
+
+    static CaptureBufferAllocator& instance() {
+        static CaptureBufferAllocator* allocator = new CaptureBufferAllocator();
+        return *allocator;
+    }
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usageFlags*/) const override {
+        // 只用于包装已有的缓冲区
+        CV_Assert(data != nullptr);
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; i--) {
+            if (step) {
+                if (step[i] != CV_AUTOSTEP) {
+                    CV_Assert(total <= step[i]);
+                    total = step[i];
+                } else {
+                    step[i] = total;
+                }
+            }
+            total *= sizes[i];
+        }
+        cv::UMatData* u = new cv::UMatData(this);
+        u->data = u->origdata = static_cast<uchar*>(data);
+        u->size = total;
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag /*accessFlags*/, cv::UMatUsageFlags /*usageFlags*/) const override {
+        return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (!u) {
+            return;
+        }
+        BufferRef* ref = static_cast<BufferRef*>(u->userdata);
+        if (ref) {
+            ref->ring->outstanding_--;
+            ref->ring->requeue(ref->index);
+            delete ref;
+        }
+        delete u;
+    }
+
+private:
+    CaptureBufferAllocator() = default;
+};
+
+cv::Mat CaptureBufferRing::wrap(int index, void* data, int rows, int cols, int type, size_t step) {
+    CaptureBufferAllocator& allocator = CaptureBufferAllocator::instance();
+    cv::Mat view(rows, cols, type, data, step);
+
+    int sizes[2] = {rows, cols};
+    size_t steps[2] = {step, CV_ELEM_SIZE(type)};
+    cv::UMatData* u = allocator.allocate(2, sizes, type, data, steps, cv::ACCESS_RW, cv::USAGE_DEFAULT);
+    u->userdata = new CaptureBufferAllocator::BufferRef{shared_from_this(), index};
+    u->refcount = 1;
+    view.u = u;
+    view.allocator = &allocator;
+    outstanding_++;
+    return view;
+}
+
+// ==================== V4L2 mmap ====================
+
+static int xioctl(int fd, unsigned long request, void* arg) {
+    int result;
+    do {
+        result = ioctl(fd, request, arg);
+    } while (result == -1 && errno == EINTR);
+    return result;
+}
+
+class V4L2MmapCapture::Ring : public CaptureBufferRing {
+public:
+    struct Buffer {
+        void* start = MAP_FAILED;
+        size_t length = 0;
+    };
+
+    ~Ring() override {
+        // 所有视图都已释放：解除映射并关闭设备，驱动随之回收缓冲区
+        for (auto& buffer : buffers) {
+            if (buffer.start != MAP_FAILED) {
+                munmap(buffer.start, buffer.length);
+            }
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    void requeue(int index) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!streaming || fd < 0) {
+            return;
+        }
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = index;
+        if (xioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+            std::cerr << "❌ [V4L2] VIDIOC_QBUF failed for buffer " << index << ": " << strerror(errno) << std::endl;
+        }
+    }
+
+    int fd = -1;
+    bool streaming = false;
+    std::vector<Buffer> buffers;
+    std::mutex mutex;  // 保护 QBUF 与 STREAMOFF 的先后顺序
+};
+
+V4L2MmapCapture::~V4L2MmapCapture() {
+    close();
+}
+
+bool V4L2MmapCapture::open(const CaptureConfig& config) {
+    close();
+
+    auto ring = std::make_shared<Ring>();
+    ring->fd = ::open(config.device.c_str(), O_RDWR | O_NONBLOCK);
+    if (ring->fd < 0) {
+        std::cerr << "❌ [V4L2] Cannot open " << config.device << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    v4l2_capability cap{};
+    if (xioctl(ring->fd, VIDIOC_QUERYCAP, &cap) < 0 ||
+        !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) || !(cap.capabilities & V4L2_CAP_STREAMING)) {
+        std::cerr << "❌ [V4L2] " << config.device << " is not a streaming capture device" << std::endl;
+        return false;
+    }
+
+    // 设置格式：优先使用请求的格式，驱动可能调整尺寸
+    v4l2_format fmt{};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = config.width;
+    fmt.fmt.pix.height = config.height;
+    fmt.fmt.pix.pixelformat = config.format == CapturePixelFormat::YUYV ? V4L2_PIX_FMT_YUYV : V4L2_PIX_FMT_MJPEG;
+    fmt.fmt.pix.field = V4L2_FIELD_ANY;
+    if (xioctl(ring->fd, VIDIOC_S_FMT, &fmt) < 0) {
+        std::cerr << "❌ [V4L2] VIDIOC_S_FMT failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_MJPEG) {
+        format_ = CapturePixelFormat::MJPEG;
+    } else if (fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_YUYV) {
+        format_ = CapturePixelFormat::YUYV;
+    } else {
+        std::cerr << "❌ [V4L2] Unsupported pixel format negotiated by driver" << std::endl;
+        return false;
+    }
+    size_ = cv::Size(fmt.fmt.pix.width, fmt.fmt.pix.height);
+    bytesPerLine_ = fmt.fmt.pix.bytesperline ? fmt.fmt.pix.bytesperline : fmt.fmt.pix.width * 2;
+
+    // 帧率（驱动不支持时忽略）
+    v4l2_streamparm parm{};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = config.fps;
+    xioctl(ring->fd, VIDIOC_S_PARM, &parm);
+
+    // 申请并映射驱动缓冲区
+    v4l2_requestbuffers req{};
+    req.count = std::max(2, config.bufferCount);
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(ring->fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+        std::cerr << "❌ [V4L2] VIDIOC_REQBUFS failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    ring->buffers.resize(req.count);
+    for (unsigned int i = 0; i < req.count; ++i) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(ring->fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            std::cerr << "❌ [V4L2] VIDIOC_QUERYBUF failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        ring->buffers[i].length = buf.length;
+        ring->buffers[i].start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, buf.m.offset);
+        if (ring->buffers[i].start == MAP_FAILED) {
+            std::cerr << "❌ [V4L2] mmap failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (xioctl(ring->fd, VIDIOC_QBUF, &buf) < 0) {
+            std::cerr << "❌ [V4L2] VIDIOC_QBUF failed: " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(ring->fd, VIDIOC_STREAMON, &type) < 0) {
+        std::cerr << "❌ [V4L2] VIDIOC_STREAMON failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    ring->streaming = true;
+    ring_ = ring;
+
+    std::cout << "✅ [V4L2] " << config.device << " streaming " << size_.width << "x" << size_.height
+              << (format_ == CapturePixelFormat::MJPEG ? " MJPEG" : " YUYV")
+              << " with " << ring_->buffers.size() << " mmap buffers" << std::endl;
+    return true;
+}
+
+void V4L2MmapCapture::close() {
+    if (!ring_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(ring_->mutex);
+        if (ring_->streaming) {
+            v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            xioctl(ring_->fd, VIDIOC_STREAMOFF, &type);
+            ring_->streaming = false;
+        }
+    }
+    // 仍被流水线持有的视图会让环继续存活，最后一个视图释放时才解除映射
+    ring_.reset();
+}
+
+bool V4L2MmapCapture::isOpened() const {
+    return ring_ && ring_->streaming;
+}
+
+int V4L2MmapCapture::bufferCount() const {
+    return ring_ ? static_cast<int>(ring_->buffers.size()) : 0;
+}
+
+int V4L2MmapCapture::buffersInUse() const {
+    return ring_ ? ring_->outstanding() : 0;
+}
+
+bool V4L2MmapCapture::read(cv::Mat& frame) {
+    if (!isOpened()) {
+        return false;
+    }
+
+    pollfd pfd{ring_->fd, POLLIN, 0};
+    int ready = poll(&pfd, 1, 1000);
+    if (ready <= 0) {
+        if (ready == 0) {
+            std::cerr << "⚠️ [V4L2] Timeout waiting for frame (buffers in use: " << buffersInUse() << ")" << std::endl;
+        }
+        return false;
+    }
+
+    v4l2_buffer buf{};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(ring_->fd, VIDIOC_DQBUF, &buf) < 0) {
+        if (errno != EAGAIN) {
+            std::cerr << "❌ [V4L2] VIDIOC_DQBUF failed: " << strerror(errno) << std::endl;
+        }
+        return false;
+    }
+
+    void* data = ring_->buffers[buf.index].start;
+    if ((buf.flags & V4L2_BUF_FLAG_ERROR) || buf.bytesused == 0) {
+        ring_->requeue(buf.index);
+        return false;
+    }
+
+    if (format_ == CapturePixelFormat::MJPEG) {
+        frame = ring_->wrap(buf.index, data, 1, static_cast<int>(buf.bytesused), CV_8UC1, buf.bytesused);
+    } else {
+        frame = ring_->wrap(buf.index, data, size_.height, size_.width, CV_8UC2, bytesPerLine_);
+    }
+    return true;
+}
+
+// ==================== 文件模拟设备 ====================
+
+class FakeFileCapture::Ring : public CaptureBufferRing {
+public:
+    void requeue(int index) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeBuffers.push_back(index);
+    }
+
+    bool take(int& index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeBuffers.empty()) {
+            return false;
+        }
+        index = freeBuffers.back();
+        freeBuffers.pop_back();
+        return true;
+    }
+
+    std::vector<std::vector<uchar>> buffers;
+    std::vector<int> freeBuffers;
+    std::mutex mutex;
+};
+
+FakeFileCapture::~FakeFileCapture() {
+    close();
+}
+
+static bool readWholeFile(const std::string& path, std::vector<uchar>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !data.empty();
+}
+
+bool FakeFileCapture::open(const CaptureConfig& config) {
+    close();
+    sourceFrames_.clear();
+    nextSource_ = 0;
+
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::string extension = fs::path(config.device).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if (extension == ".yuv" || extension == ".yuyv") {
+        // 原始 YUYV 文件：按配置的宽高切成若干帧
+        std::vector<uchar> data;
+        size_t frameBytes = static_cast<size_t>(config.width) * config.height * 2;
+        if (!readWholeFile(config.device, data) || frameBytes == 0 || data.size() < frameBytes) {
+            std::cerr << "❌ [FAKE CAPTURE] Cannot read YUYV frames from " << config.device << std::endl;
+            return false;
+        }
+        for (size_t offset = 0; offset + frameBytes <= data.size(); offset += frameBytes) {
+            sourceFrames_.emplace_back(data.begin() + offset, data.begin() + offset + frameBytes);
+        }
+        format_ = CapturePixelFormat::YUYV;
+        size_ = cv::Size(config.width, config.height);
+    } else {
+        // 单个 JPEG 文件或包含 JPEG 文件的目录（按文件名排序循环播放）
+        std::vector<std::string> paths;
+        if (fs::is_directory(config.device, ec)) {
+            for (const auto& entry : fs::directory_iterator(config.device, ec)) {
+                std::string ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                if (ext == ".jpg" || ext == ".jpeg") {
+                    paths.push_back(entry.path().string());
+                }
+            }
+            std::sort(paths.begin(), paths.end());
+        } else {
+            paths.push_back(config.device);
+        }
+
+        for (const auto& path : paths) {
+            std::vector<uchar> data;
+            if (readWholeFile(path, data) && data.size() > 2 && data[0] == 0xFF && data[1] == 0xD8) {
+                sourceFrames_.push_back(std::move(data));
+            } else {
+                std::cerr << "⚠️ [FAKE CAPTURE] Skipping non-JPEG file: " << path << std::endl;
+            }
+        }
+        if (sourceFrames_.empty()) {
+            std::cerr << "❌ [FAKE CAPTURE] No JPEG frames found at " << config.device << std::endl;
+            return false;
+        }
+
+        cv::Mat first = cv::imdecode(sourceFrames_.front(), cv::IMREAD_COLOR);
+        if (first.empty()) {
+            std::cerr << "❌ [FAKE CAPTURE] Cannot decode " << paths.front() << std::endl;
+            return false;
+        }
+        format_ = CapturePixelFormat::MJPEG;
+        size_ = first.size();
+    }
+
+    // 与驱动一样预先分配固定数量的缓冲区
+    auto ring = std::make_shared<Ring>();
+    size_t largest = 0;
+    for (const auto& source : sourceFrames_) {
+        largest = std::max(largest, source.size());
+    }
+    ring->buffers.assign(std::max(2, config.bufferCount), std::vector<uchar>(largest));
+    for (int i = static_cast<int>(ring->buffers.size()) - 1; i >= 0; --i) {
+        ring->freeBuffers.push_back(i);
+    }
+    ring_ = ring;
+
+    frameInterval_ = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / std::max(1, config.fps)));
+    nextFrameTime_ = std::chrono::steady_clock::now();
+
+    std::cout << "✅ [FAKE CAPTURE] " << config.device << ": " << sourceFrames_.size() << " frame(s) "
+              << size_.width << "x" << size_.height << (format_ == CapturePixelFormat::MJPEG ? " MJPEG" : " YUYV")
+              << " with " << ring_->buffers.size() << " buffers" << std::endl;
+    return true;
+}
+
+void FakeFileCapture::close() {
+    ring_.reset();
+}
+
+bool FakeFileCapture::isOpened() const {
+    return ring_ != nullptr;
+}
+
+int FakeFileCapture::bufferCount() const {
+    return ring_ ? static_cast<int>(ring_->buffers.size()) : 0;
+}
+
+int FakeFileCapture::buffersInUse() const {
+    return ring_ ? ring_->outstanding() : 0;
+}
+
+bool FakeFileCapture::read(cv::Mat& frame) {
+    if (!ring_) {
+        return false;
+    }
+
+    // 按帧率节拍输出
+    std::this_thread::sleep_until(nextFrameTime_);
+    nextFrameTime_ = std::max(nextFrameTime_ + frameInterval_, std::chrono::steady_clock::now());
+
+    // 所有缓冲区都被下游持有时与真实驱动一样取不到帧
+    int index;
+    if (!ring_->take(index)) {
+        std::cerr << "⚠️ [FAKE CAPTURE] All buffers in use, frame dropped" << std::endl;
+        return false;
+    }
+
+    const std::vector<uchar>& source = sourceFrames_[nextSource_];
+    nextSource_ = (nextSource_ + 1) % sourceFrames_.size();
+    std::vector<uchar>& buffer = ring_->buffers[index];
+    std::copy(source.begin(), source.end(), buffer.begin());
+
+    if (format_ == CapturePixelFormat::MJPEG) {
+        frame = ring_->wrap(index, buffer.data(), 1, static_cast<int>(source.size()), CV_8UC1, source.size());
+    } else {
+        frame = ring_->wrap(index, buffer.data(), size_.height, size_.width, CV_8UC2, size_.width * 2);
+    }
+    return true;
+}
@@ -0,0 +1,148 @@
+#include "../include/ChessboardTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const cv::Size kTrackWindow(21, 21);
+const int kPyramidLevels = 3;
+const float kMaxTrackError = 20.0f;   // LK 的平均灰度误差上限，超过说明角点被遮挡或移出
+const float kMaxStepRatio = 1.8f;     // 相邻网格间距之比的上限（允许透视引起的渐变）
+const float kMinStepCosine = 0.8f;    // 相邻网格方向夹角余弦的下限（约 37°）
+const float kMinStepLength = 2.0f;    // 相邻角点的最小间距（像素）
+const int kMaxRefineHalfWindow = 5;   // 亚像素细化的最大半窗口（像素）
+
+// 检查沿一条网格线的相邻间距是否平滑变化
+bool isSmoothLine(const std::vector<cv::Point2f>& corners, int start, int stride, int count) {
+    cv::Point2f previousStep;
+    float previousLength = 0.0f;
+    for (int i = 0; i + 1 < count; ++i) {
+        cv::Point2f step = corners[start + (i + 1) * stride] - corners[start + i * stride];
+        float length = static_cast<float>(cv::norm(step));
+        if (length < kMinStepLength) {
+            return false;
+        }
+        if (i > 0) {
+            float ratio = length / previousLength;
+            float cosine = step.dot(previousStep) / (length * previousLength);
+            if (ratio > kMaxStepRatio || ratio < 1.0f / kMaxStepRatio || cosine < kMinStepCosine) {
+                return false;
+            }
+        }
+        previousStep = step;
+        previousLength = length;
+    }
+    return true;
+}
+}
+
+void ChessboardTracker::reset(const cv::Mat& gray, const cv::Size& boardSize, const std::vector<cv::Point2f>& corners) {
+    if (gray.empty() || static_cast<int>(corners.size()) != boardSize.area()) {
+        clear();
+        return;
+    }
+    boardSize_ = boardSize;
+    corners_ = corners;
+    cv::buildOpticalFlowPyramid(gray, previousPyramid_, kTrackWindow, kPyramidLevels);
+    trackedFrames_ = 0;
+}
+
+void ChessboardTracker::clear() {
+    corners_.clear();
+    previousPyramid_.clear();
+    trackedFrames_ = 0;
+}
+
+bool ChessboardTracker::update(const cv::Mat& gray, std::vector<cv::Point2f>& corners) {
+    if (!isTracking() || gray.empty() || gray.size() != previousPyramid_[0].size()) {
+        clear();
+        return false;
+    }
+
+    std::vector<cv::Mat> pyramid;
+    cv::buildOpticalFlowPyramid(gray, pyramid, kTrackWindow, kPyramidLevels);
+
+    std::vector<cv::Point2f> tracked;
+    std::vector<uchar> status;
+    std::vector<float> error;
+    cv::calcOpticalFlowPyrLK(previousPyramid_, pyramid, corners_, tracked, status, error, kTrackWindow, kPyramidLevels,
+                             cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 20, 0.03));
+
+    for (size_t i = 0; i < tracked.size(); ++i) {
+        if (!status[i] || error[i] > kMaxTrackError) {
+            clear();
+            return false;
+        }
+    }
+    if (!isValidGrid(tracked, gray.size())) {
+        clear();
+        return false;
+    }
+
+    // 光流结果逐帧累积误差，接受前在当前帧上做亚像素细化，使角点重新贴合棋盘格的实际角点
+    // 半窗口不超过最小网格间距的 1/4，避免收敛到相邻角点
+    float minStep = std::numeric_limits<float>::max();
+    for (int row = 0; row < boardSize_.height; ++row) {
+        for (int col = 0; col + 1 < boardSize_.width; ++col) {
+            const int index = row * boardSize_.width + col;
+            minStep = std::min(minStep, static_cast<float>(cv::norm(tracked[index + 1] - tracked[index])));
+        }
+    }
+    const int halfWindow = std::min(kMaxRefineHalfWindow, static_cast<int>(minStep / 4));
+    if (halfWindow >= 2) {
+        cv::cornerSubPix(gray, tracked, cv::Size(halfWindow, halfWindow), cv::Size(-1, -1),
+                         cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 10, 0.05));
+        if (!isValidGrid(tracked, gray.size())) {
+            clear();
+            return false;
+        }
+    }
+
+    corners_ = tracked;
+    previousPyramid_ = std::move(pyramid);
+    trackedFrames_++;
+    corners = corners_;
+    return true;
+}
+
+bool ChessboardTracker::isValidGrid(const std::vector<cv::Point2f>& corners, const cv::Size& imageSize) const {
+    const int cols = boardSize_.width;
+    const int rows = boardSize_.height;
+    if (static_cast<int>(corners.size()) != cols * rows) {
+        return false;
+    }
+
+    cv::Rect2f bounds(0.0f, 0.0f, static_cast<float>(imageSize.width), static_cast<float>(imageSize.height));
+    for (const auto& corner : corners) {
+        if (!bounds.contains(corner)) {
+            return false;
+        }
+    }
+
+    // 每一行、每一列的间距和方向都应平滑变化
+    for (int row = 0; row < rows; ++row) {
+        if (!isSmoothLine(corners, row * cols, 1, cols)) {
+            return false;
+        }
+    }
+    for (int col = 0; col < cols; ++col) {
+        if (!isSmoothLine(corners, col, cols, rows)) {
+            return false;
+        }
+    }
+
+    // 所有格子的朝向一致（行方向与列方向叉积同号），排除网格翻折
+    double orientation = 0.0;
+    for (int row = 0; row + 1 < rows; ++row) {
+        for (int col = 0; col + 1 < cols; ++col) {
+            const cv::Point2f& origin = corners[row * cols + col];
+            double cross = (corners[row * cols + col + 1] - origin).cross(corners[(row + 1) * cols + col] - origin);
+            if (orientation == 0.0) {
+                orientation = cross;
+            } else if (cross * orientation <= 0.0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
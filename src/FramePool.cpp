@@ -0,0 +1,125 @@
+#include "../include/FramePool.h"
+
+FramePool& FramePool::instance() {
+    // 故意不析构：全局/静态 Mat 可能在程序退出时才释放，仍需要分配器有效
+    static FramePool* pool = new FramePool();
+    return *pool;
+}
+
+cv::Mat FramePool::acquire(cv::Size size, int type) {
+    cv::Mat mat;
+    mat.allocator = this;
+    mat.create(size, type);
+    return mat;
+}
+
+void FramePool::attach(cv::Mat& mat) {
+    if (mat.empty()) {
+        mat.allocator = this;
+    }
+}
+
+void FramePool::setMaxBuffersPerSize(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxBuffersPerSize_ = count;
+}
+
+FramePool::Stats FramePool::getStats() const {
+    Stats stats;
+    stats.allocations = allocations_;
+    stats.reuses = reuses_;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.pooledBuffers = pooledBuffers_;
+    stats.pooledBytes = pooledBytes_;
+    return stats;
+}
+
+void FramePool::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : freeBuffers_) {
+        for (uchar* buffer : entry.second) {
+            cv::fastFree(buffer);
+        }
+    }
+    freeBuffers_.clear();
+    pooledBuffers_ = 0;
+    pooledBytes_ = 0;
+}
+
+uchar* FramePool::takeBuffer(size_t bytes) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = freeBuffers_.find(bytes);
+        if (it != freeBuffers_.end() && !it->second.empty()) {
+            uchar* buffer = it->second.back();
+            it->second.pop_back();
+            pooledBuffers_--;
+            pooledBytes_ -= bytes;
+            reuses_++;
+            return buffer;
+        }
+    }
+
+    allocations_++;
+    return static_cast<uchar*>(cv::fastMalloc(bytes));
+}
+
+void FramePool::returnBuffer(uchar* buffer, size_t bytes) const {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& buffers = freeBuffers_[bytes];
+        if (buffers.size() < maxBuffersPerSize_) {
+            buffers.push_back(buffer);
+            pooledBuffers_++;
+            pooledBytes_ += bytes;
+            return;
+        }
+    }
+
+    // 该尺寸的空闲缓冲区已满，直接释放
+    cv::fastFree(buffer);
+}
+
+cv::UMatData* FramePool::allocate(int dims, const int* sizes, int type, void* data0, size_t* step,
+                                  cv::AccessFlag /*flags*/, cv::UMatUsageFlags /*usageFlags*/) const {
+    // 与 OpenCV 默认分配器相同的步长计算
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data0 && step[i] != CV_AUTOSTEP) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    uchar* data = data0 ? static_cast<uchar*>(data0) : takeBuffer(total);
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = data;
+    u->size = total;
+    if (data0) {
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+    }
+    return u;
+}
+
+bool FramePool::allocate(cv::UMatData* u, cv::AccessFlag /*accessFlags*/, cv::UMatUsageFlags /*usageFlags*/) const {
+    return u != nullptr;
+}
+
+void FramePool::deallocate(cv::UMatData* u) const {
+    if (!u) {
+        return;
+    }
+
+    CV_Assert(u->urefcount == 0);
+    CV_Assert(u->refcount == 0);
+    if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+        returnBuffer(u->origdata, u->size);
+        u->origdata = nullptr;
+    }
+    delete u;
+}
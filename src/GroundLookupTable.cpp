@@ -0,0 +1,141 @@
+#include "../include/GroundLookupTable.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const char kFileMagic[8] = {'G', 'R', 'N', 'D', 'L', 'U', 'T', '1'};
+
+// 缓存文件头，节点数据（float x/y 交错）紧跟其后；文件只在本机生成和读取，按本机字节序存储
+struct FileHeader {
+    char magic[8];
+    int32_t imageWidth;
+    int32_t imageHeight;
+    int32_t cellSize;
+    int32_t gridCols;
+    int32_t gridRows;
+    int32_t reserved;
+    double homography[9];
+};
+static_assert(sizeof(FileHeader) % alignof(float) == 0, "node data must stay aligned");
+}
+
+GroundLookupTable::GroundLookupTable(const cv::Matx33d& homography, const cv::Size& imageSize, int cellSize)
+    : homography_(homography), imageSize_(imageSize), cellSize_(std::max(1, cellSize)) {
+    gridCols_ = std::max(2, (imageSize_.width - 1 + cellSize_ - 1) / cellSize_ + 1);
+    gridRows_ = std::max(2, (imageSize_.height - 1 + cellSize_ - 1) / cellSize_ + 1);
+    inverseCell_ = 1.0f / cellSize_;
+    maxX_ = static_cast<float>(std::max(0, imageSize_.width - 1));
+    maxY_ = static_cast<float>(std::max(0, imageSize_.height - 1));
+}
+
+GroundLookupTable::~GroundLookupTable() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+}
+
+std::shared_ptr<const GroundLookupTable> GroundLookupTable::build(const cv::Matx33d& homography,
+                                                                  const cv::Size& imageSize, int cellSize) {
+    if (imageSize.width <= 0 || imageSize.height <= 0) {
+        return nullptr;
+    }
+    std::shared_ptr<GroundLookupTable> table(new GroundLookupTable(homography, imageSize, cellSize));
+
+    // 按行生成节点坐标后原地做透视变换
+    table->ownedNodes_.resize(static_cast<size_t>(table->gridCols_) * table->gridRows_);
+    for (int row = 0; row < table->gridRows_; ++row) {
+        cv::Mat_<cv::Point2f> nodes(1, table->gridCols_, table->ownedNodes_.data() + static_cast<size_t>(row) * table->gridCols_);
+        for (int col = 0; col < table->gridCols_; ++col) {
+            nodes(0, col) = cv::Point2f(static_cast<float>(col * table->cellSize_),
+                                        static_cast<float>(row * table->cellSize_));
+        }
+        cv::perspectiveTransform(nodes, nodes, cv::Mat(homography));
+    }
+    table->nodes_ = table->ownedNodes_.data();
+    return table;
+}
+
+std::shared_ptr<const GroundLookupTable> GroundLookupTable::load(const std::string& filename,
+                                                                 const cv::Matx33d& homography,
+                                                                 const cv::Size& imageSize, int cellSize) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        return nullptr;
+    }
+    const size_t fileSize = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // 映射建立后文件描述符不再需要
+    if (mapping == MAP_FAILED) {
+        std::cerr << "❌ [GROUND LUT] mmap failed for " << filename << ": " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<GroundLookupTable> table(new GroundLookupTable(homography, imageSize, cellSize));
+    table->mapping_ = mapping;
+    table->mappingSize_ = fileSize;
+
+    // 矩阵逐位比较：从同一个标定文件加载的矩阵每次都完全相同，任何变化都意味着缓存已过期
+    const FileHeader* header = static_cast<const FileHeader*>(mapping);
+    bool valid = std::memcmp(header->magic, kFileMagic, sizeof(kFileMagic)) == 0 &&
+                 header->imageWidth == imageSize.width && header->imageHeight == imageSize.height &&
+                 header->cellSize == table->cellSize_ && header->gridCols == table->gridCols_ &&
+                 header->gridRows == table->gridRows_ &&
+                 std::memcmp(header->homography, homography.val, sizeof(header->homography)) == 0 &&
+                 fileSize == sizeof(FileHeader) + table->byteSize();
+    if (!valid) {
+        return nullptr;  // 析构时解除映射
+    }
+    table->nodes_ = reinterpret_cast<const cv::Point2f*>(static_cast<const char*>(mapping) + sizeof(FileHeader));
+    return table;
+}
+
+bool GroundLookupTable::save(const std::string& filename) const {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+    header.imageWidth = imageSize_.width;
+    header.imageHeight = imageSize_.height;
+    header.cellSize = cellSize_;
+    header.gridCols = gridCols_;
+    header.gridRows = gridRows_;
+    std::memcpy(header.homography, homography_.val, sizeof(header.homography));
+
+    const std::string temporary = filename + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        std::cerr << "❌ [GROUND LUT] Could not open " << temporary << " for writing: " << strerror(errno) << std::endl;
+        return false;
+    }
+    bool success = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(nodes_, byteSize(), 1, file) == 1;
+    success = (std::fclose(file) == 0) && success;
+    if (!success || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        std::cerr << "❌ [GROUND LUT] Failed to write " << filename << ": " << strerror(errno) << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t GroundLookupTable::lookupBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        if (!contains(src[i])) {
+            return i;
+        }
+        dst[i] = interpolate(src[i]);
+    }
+    return count;
+}
@@ -1,4 +1,49 @@
 #include "../include/HomographyMapper.h"
+#include <opencv2/core/version.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// 对 count 个点应用 3x3 单应性矩阵，公式和退化处理（|w| <= FLT_EPSILON 时输出 (0, 0)）与 cv::perspectiveTransform 相同
+// 在 double 精度下计算；支持 64 位浮点向量时一次处理一整个 float32 向量的点，允许 src == dst
+// 向量路径使用 v_mul/v_div/v_gt 等函数形式的通用指令（OpenCV 4.8 起提供），更早的版本只用标量路径
+#define HOMOGRAPHY_MAPPER_SIMD (CV_SIMD_64F && (CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 8)))
+static void applyHomography(const cv::Matx33d& m, const cv::Point2f* src, cv::Point2f* dst, size_t count) {
+    size_t i = 0;
+#if HOMOGRAPHY_MAPPER_SIMD
+    const size_t lanes = CV_SIMD_WIDTH / sizeof(float);
+    const v_float64 m00 = vx_setall_f64(m(0, 0)), m01 = vx_setall_f64(m(0, 1)), m02 = vx_setall_f64(m(0, 2));
+    const v_float64 m10 = vx_setall_f64(m(1, 0)), m11 = vx_setall_f64(m(1, 1)), m12 = vx_setall_f64(m(1, 2));
+    const v_float64 m20 = vx_setall_f64(m(2, 0)), m21 = vx_setall_f64(m(2, 1)), m22 = vx_setall_f64(m(2, 2));
+    const v_float64 eps = vx_setall_f64(FLT_EPSILON), one = vx_setall_f64(1.0), zero = vx_setzero_f64();
+    const float* in = reinterpret_cast<const float*>(src);
+    float* out = reinterpret_cast<float*>(dst);
+    for (; i + lanes <= count; i += lanes) {
+        v_float32 x, y;
+        v_load_deinterleave(in + 2 * i, x, y);
+        v_float64 xs[2] = {v_cvt_f64(x), v_cvt_f64_high(x)};
+        v_float64 ys[2] = {v_cvt_f64(y), v_cvt_f64_high(y)};
+        v_float64 gx[2], gy[2];
+        for (int h = 0; h < 2; ++h) {
+            v_float64 w = v_fma(m20, xs[h], v_fma(m21, ys[h], m22));
+            w = v_select(v_gt(v_abs(w), eps), v_div(one, w), zero);
+            gx[h] = v_mul(v_fma(m00, xs[h], v_fma(m01, ys[h], m02)), w);
+            gy[h] = v_mul(v_fma(m10, xs[h], v_fma(m11, ys[h], m12)), w);
+        }
+        v_store_interleave(out + 2 * i, v_cvt_f32(gx[0], gx[1]), v_cvt_f32(gy[0], gy[1]));
+    }
+    vx_cleanup();
+#endif
+    for (; i < count; ++i) {
+        double x = src[i].x, y = src[i].y;
+        double w = m(2, 0) * x + m(2, 1) * y + m(2, 2);
+        w = std::fabs(w) > FLT_EPSILON ? 1.0 / w : 0.0;
+        dst[i] = cv::Point2f(static_cast<float>((m(0, 0) * x + m(0, 1) * y + m(0, 2)) * w),
+                             static_cast<float>((m(1, 0) * x + m(1, 1) * y + m(1, 2)) * w));
+    }
+}
 
 HomographyMapper::HomographyMapper() : calibrated_(false) {
     // 初始化单应性矩阵为空
@@ -78,24 +123,103 @@ bool HomographyMapper::computeHomography() {
         return false;
     }
     
+    updateCachedMatrices();
     calibrated_ = true;
     return true;
 }
 
+void HomographyMapper::updateCachedMatrices() {
+    homography33_ = cv::Matx33d();
+    inverseHomography33_ = cv::Matx33d();
+    if (homographyMatrix_.rows == 3 && homographyMatrix_.cols == 3) {
+        cv::Mat_<double> matrix;
+        homographyMatrix_.convertTo(matrix, CV_64F);
+        homography33_ = cv::Matx33d(matrix.ptr<double>());
+    }
+    if (inverseHomographyMatrix_.rows == 3 && inverseHomographyMatrix_.cols == 3) {
+        cv::Mat_<double> matrix;
+        inverseHomographyMatrix_.convertTo(matrix, CV_64F);
+        inverseHomography33_ = cv::Matx33d(matrix.ptr<double>());
+    }
+    rebuildGroundLookupTable();
+}
+
+void HomographyMapper::enableGroundLookupTable(const cv::Size& imageSize, int cellSize, const std::string& cachePath) {
+    groundLutImageSize_ = imageSize;
+    groundLutCellSize_ = std::max(1, cellSize);
+    groundLutCachePath_ = cachePath;
+    rebuildGroundLookupTable();
+}
+
+void HomographyMapper::disableGroundLookupTable() {
+    groundLutCellSize_ = 0;
+    std::atomic_store(&groundLut_, std::shared_ptr<const GroundLookupTable>());
+}
+
+std::shared_ptr<const GroundLookupTable> HomographyMapper::getGroundLookupTable() const {
+    return std::atomic_load(&groundLut_);
+}
+
+void HomographyMapper::rebuildGroundLookupTable() {
+    // 在局部变量中构建，完成后整体发布；映射线程随时可能读取 groundLut_
+    std::atomic_store(&groundLut_, std::shared_ptr<const GroundLookupTable>());
+    if (groundLutCellSize_ <= 0 || homographyMatrix_.rows != 3 || homographyMatrix_.cols != 3) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const GroundLookupTable> table;
+    try {
+        if (!groundLutCachePath_.empty()) {
+            table = GroundLookupTable::load(groundLutCachePath_, homography33_, groundLutImageSize_, groundLutCellSize_);
+        }
+        bool mapped = table != nullptr;
+        if (!mapped) {
+            table = GroundLookupTable::build(homography33_, groundLutImageSize_, groundLutCellSize_);
+            if (table && !groundLutCachePath_.empty()) {
+                table->save(groundLutCachePath_);
+            }
+        }
+        if (table) {
+            double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "✅ [GROUND LUT] " << (mapped ? "Mapped " : "Built ") << groundLutImageSize_.width << "x"
+                      << groundLutImageSize_.height << " table (cell " << groundLutCellSize_ << ", "
+                      << table->byteSize() / 1024 << " KB) in " << elapsedMs << " ms" << std::endl;
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "❌ [GROUND LUT] Failed to build lookup table: " << e.what() << std::endl;
+        return;
+    }
+    std::atomic_store(&groundLut_, std::move(table));
+}
+
+void HomographyMapper::mapImageToGround(const cv::Point2f* src, cv::Point2f* dst, size_t count) const {
+    // 每次调用只取一次快照，整批点使用同一张表
+    std::shared_ptr<const GroundLookupTable> table = std::atomic_load(&groundLut_);
+    if (!table) {
+        applyHomography(homography33_, src, dst, count);
+        return;
+    }
+    // 连续命中的点整段查表，超出表范围的点逐个按矩阵计算
+    size_t i = 0;
+    while (i < count) {
+        i += table->lookupBatch(src + i, dst + i, count - i);
+        if (i < count) {
+            applyHomography(homography33_, src + i, dst + i, 1);
+            ++i;
+        }
+    }
+}
+
 cv::Point2f HomographyMapper::imageToGround(const cv::Point2f& imagePoint) const {
     if (!calibrated_) {
         std::cerr << "Warning: Homography not calibrated. Returning input point." << std::endl;
         return imagePoint;
     }
     
-    // 创建输入点的向量
-    std::vector<cv::Point2f> srcPoints = {imagePoint};
-    std::vector<cv::Point2f> dstPoints;
-    
-    // 应用透视变换
-    cv::perspectiveTransform(srcPoints, dstPoints, homographyMatrix_);
-    
-    return dstPoints[0];
+    cv::Point2f groundPoint;
+    mapImageToGround(&imagePoint, &groundPoint, 1);
+    return groundPoint;
 }
 
 cv::Point2f HomographyMapper::groundToImage(const cv::Point2f& groundPoint) const {
@@ -104,14 +228,27 @@ cv::Point2f HomographyMapper::groundToImage(const cv::Point2f& groundPoint) cons
         return groundPoint;
     }
     
-    // 创建输入点的向量
-    std::vector<cv::Point2f> srcPoints = {groundPoint};
-    std::vector<cv::Point2f> dstPoints;
-    
-    // 应用透视变换
-    cv::perspectiveTransform(srcPoints, dstPoints, inverseHomographyMatrix_);
-    
-    return dstPoints[0];
+    cv::Point2f imagePoint;
+    applyHomography(inverseHomography33_, &groundPoint, &imagePoint, 1);
+    return imagePoint;
+}
+
+bool HomographyMapper::imageToGroundBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const {
+    if (!calibrated_) {
+        std::copy(src, src + count, dst);
+        return false;
+    }
+    mapImageToGround(src, dst, count);
+    return true;
+}
+
+bool HomographyMapper::groundToImageBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const {
+    if (!calibrated_) {
+        std::copy(src, src + count, dst);
+        return false;
+    }
+    applyHomography(inverseHomography33_, src, dst, count);
+    return true;
 }
 
 bool HomographyMapper::saveHomography(const std::string& filename) const {
@@ -168,6 +305,7 @@ bool HomographyMapper::loadHomography(const std::string& filename) {
         
         // 计算逆矩阵
         inverseHomographyMatrix_ = homographyMatrix_.inv();
+        updateCachedMatrices();
         
         // 加载标定点
         int numPoints;
@@ -234,6 +372,7 @@ void HomographyMapper::setHomographyMatrix(const cv::Mat& matrix) {
     if (!matrix.empty()) {
         inverseHomographyMatrix_ = matrix.inv();
     }
+    updateCachedMatrices();
 }
 
 cv::Mat HomographyMapper::getInverseHomographyMatrix() const {
@@ -249,7 +388,11 @@ bool HomographyMapper::detectArUcoMarkers(const cv::Mat& frame, std::vector<int>
         markerCorners.clear();
         
         // 检测 ArUco 标记
-        cv::aruco::detectMarkers(frame, markerDictionary_, markerCorners, markerIds, detectorParams_);
+        if (arucoDetectionScale_ < 1.0) {
+            detectArUcoMarkersTwoScale(frame, markerIds, markerCorners);
+        } else {
+            cv::aruco::detectMarkers(frame, markerDictionary_, markerCorners, markerIds, detectorParams_);
+        }
         
         if (markerIds.size() > 0) {
             // 简洁的调试信息
@@ -276,6 +419,86 @@ bool HomographyMapper::detectArUcoMarkers(const cv::Mat& frame, std::vector<int>
     }
 }
 
+bool HomographyMapper::detectArUcoMarkersTwoScale(const cv::Mat& frame, std::vector<int>& markerIds,
+                                                  std::vector<std::vector<cv::Point2f>>& markerCorners) {
+    const double scale = arucoDetectionScale_;
+    
+    // 缩小图像上的参数：每次从当前检测参数复制（复制很便宜，参数调整立即生效），
+    // 自适应阈值窗口按比例缩小，不做角点细化（细化在全分辨率上进行）
+    if (!coarseDetectorParams_) {
+        coarseDetectorParams_ = cv::makePtr<cv::aruco::DetectorParameters>();
+    }
+    *coarseDetectorParams_ = *detectorParams_;
+    auto scaleWindow = [scale](int size) { return std::max(3, static_cast<int>(std::lround(size * scale)) | 1); };
+    coarseDetectorParams_->adaptiveThreshWinSizeMin = scaleWindow(detectorParams_->adaptiveThreshWinSizeMin);
+    coarseDetectorParams_->adaptiveThreshWinSizeMax = std::max(coarseDetectorParams_->adaptiveThreshWinSizeMin,
+                                                               scaleWindow(detectorParams_->adaptiveThreshWinSizeMax));
+    coarseDetectorParams_->adaptiveThreshWinSizeStep = std::max(1, static_cast<int>(std::lround(detectorParams_->adaptiveThreshWinSizeStep * scale)));
+    coarseDetectorParams_->cornerRefinementMethod = cv::aruco::CORNER_REFINE_NONE;
+    
+    cv::resize(frame, arucoSmallFrame_, cv::Size(), scale, scale, cv::INTER_AREA);
+    cv::aruco::detectMarkers(arucoSmallFrame_, markerDictionary_, markerCorners, markerIds, coarseDetectorParams_);
+    
+    // 角点换算回全分辨率（像素中心对齐），再在每个角点附近的全分辨率灰度 ROI 上做亚像素细化
+    // 搜索窗口要覆盖缩小带来的误差（约 1/scale 像素），同时不超过标记边长的 1/4
+    const double inverseScale = 1.0 / scale;
+    const cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+    const cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS,
+                                    std::max(1, detectorParams_->cornerRefinementMaxIterations),
+                                    detectorParams_->cornerRefinementMinAccuracy);
+    cv::Mat grayRoi;
+    for (auto& corners : markerCorners) {
+        float minSide = std::numeric_limits<float>::max();
+        for (size_t j = 0; j < corners.size(); ++j) {
+            corners[j].x = static_cast<float>((corners[j].x + 0.5) * inverseScale - 0.5);
+            corners[j].y = static_cast<float>((corners[j].y + 0.5) * inverseScale - 0.5);
+        }
+        for (size_t j = 0; j < corners.size(); ++j) {
+            minSide = std::min(minSide, static_cast<float>(cv::norm(corners[(j + 1) % corners.size()] - corners[j])));
+        }
+        int halfWindow = std::max(detectorParams_->cornerRefinementWinSize, static_cast<int>(std::ceil(2.0 * inverseScale)));
+        halfWindow = std::min(halfWindow, static_cast<int>(minSide / 4));
+        if (halfWindow < 2) {
+            continue;  // 标记太小，保留换算后的角点
+        }
+        
+        cv::Rect roi = cv::boundingRect(corners);
+        roi.x -= halfWindow + 2;
+        roi.y -= halfWindow + 2;
+        roi.width += 2 * (halfWindow + 2);
+        roi.height += 2 * (halfWindow + 2);
+        roi &= frameRect;
+        if (roi.empty()) {
+            continue;
+        }
+        
+        if (frame.channels() == 3) {
+            cv::cvtColor(frame(roi), grayRoi, cv::COLOR_BGR2GRAY);
+        } else {
+            grayRoi = frame(roi);
+        }
+        const cv::Point2f offset(static_cast<float>(roi.x), static_cast<float>(roi.y));
+        for (auto& corner : corners) {
+            corner -= offset;
+        }
+        cv::cornerSubPix(grayRoi, corners, cv::Size(halfWindow, halfWindow), cv::Size(-1, -1), criteria);
+        for (auto& corner : corners) {
+            corner += offset;
+        }
+    }
+    return !markerIds.empty();
+}
+
+void HomographyMapper::setArUcoDetectionScale(double scale) {
+    arucoDetectionScale_ = std::min(1.0, std::max(0.1, scale));
+    std::cout << "[ArUco 参数] 检测缩放比例: " << arucoDetectionScale_
+              << (arucoDetectionScale_ < 1.0 ? "（缩小检测 + 全分辨率细化）" : "（单级全分辨率检测）") << std::endl;
+}
+
+double HomographyMapper::getArUcoDetectionScale() const {
+    return arucoDetectionScale_;
+}
+
 void HomographyMapper::drawDetectedMarkers(cv::Mat& frame, const std::vector<int>& markerIds, 
                                         const std::vector<std::vector<cv::Point2f>>& markerCorners) {
     if (markerIds.size() > 0) {
@@ -371,7 +594,8 @@ void HomographyMapper::drawDetectedMarkers(cv::Mat& frame, const std::vector<int
 }
 
 bool HomographyMapper::calibrateFromArUcoMarkers(const cv::Mat& frame, 
-                                               const std::map<int, cv::Point2f>& markerGroundCoordinates) {
+                                               const std::map<int, cv::Point2f>& markerGroundCoordinates,
+                                               const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs) {
     std::cout << "[ArUco 标定] 开始从ArUco标记进行标定..." << std::endl;
     std::cout << "[ArUco 标定] 已设置地面坐标的标记数量: " << markerGroundCoordinates.size() << std::endl;
     
@@ -389,8 +613,10 @@ bool HomographyMapper::calibrateFromArUcoMarkers(const cv::Mat& frame,
     
     // 统计可用于标定的标记数量
     int usableMarkers = 0;
+    std::vector<cv::Point2f> imageCenters;
+    std::vector<cv::Point2f> groundCenters;
     
-    // 使用标记中心点和地面坐标添加标定点对
+    // 收集标记中心点和地面坐标
     for (size_t i = 0; i < markerIds.size(); i++) {
         int id = markerIds[i];
         auto it = markerGroundCoordinates.find(id);
@@ -403,8 +629,8 @@ bool HomographyMapper::calibrateFromArUcoMarkers(const cv::Mat& frame,
             }
             center *= 0.25f;
             
-            // 添加标定点对
-            addCalibrationPoint(center, it->second);
+            imageCenters.push_back(center);
+            groundCenters.push_back(it->second);
             usableMarkers++;
             
             std::cout << "[ArUco 标定] 标记 " << id << ": 图像坐标(" 
@@ -415,6 +641,22 @@ bool HomographyMapper::calibrateFromArUcoMarkers(const cv::Mat& frame,
         }
     }
     
+    // 只校正标记中心点，不需要对整帧去畸变
+    if (!imageCenters.empty() && !cameraMatrix.empty() && !distCoeffs.empty()) {
+        try {
+            cv::undistortPoints(imageCenters, imageCenters, cameraMatrix, distCoeffs, cv::noArray(), cameraMatrix);
+            std::cout << "[ArUco 标定] 标记中心已按相机内参去畸变" << std::endl;
+        } catch (const cv::Exception& e) {
+            std::cerr << "[ArUco 标定] 标记中心去畸变失败: " << e.what() << std::endl;
+            return false;
+        }
+    }
+    
+    // 添加标定点对
+    for (size_t i = 0; i < imageCenters.size(); i++) {
+        addCalibrationPoint(imageCenters[i], groundCenters[i]);
+    }
+    
     if (usableMarkers < 4) {
         std::cerr << "[ArUco 标定] 错误: 可用标记数量不足 (" << usableMarkers 
                   << "/4)，需要至少4个已设置地面坐标的标记" << std::endl;
@@ -646,6 +888,53 @@ cv::Point2f HomographyMapper::groundToImageWithOrigin(const cv::Point2f& groundP
     return groundToImage(absoluteGroundPoint);
 }
 
+void HomographyMapper::convertToPolarBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = convertToPolar(src[i]);
+    }
+}
+
+void HomographyMapper::convertToCartesianBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = convertToCartesian(src[i]);
+    }
+}
+
+bool HomographyMapper::imageToGroundWithOriginBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const {
+    if (!calibrated_) {
+        std::fill(dst, dst + count, cv::Point2f(0, 0));
+        return false;
+    }
+    
+    mapImageToGround(src, dst, count);
+    if (coordinateType_ == "polar") {
+        convertToPolarBatch(dst, dst, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] -= origin_;
+        }
+    }
+    return true;
+}
+
+bool HomographyMapper::groundToImageWithOriginBatch(const cv::Point2f* src, cv::Point2f* dst, size_t count) const {
+    if (!calibrated_) {
+        std::fill(dst, dst + count, cv::Point2f(0, 0));
+        return false;
+    }
+    
+    // 先在 dst 中换算为绝对地面坐标，再原地变换到图像坐标
+    if (coordinateType_ == "polar") {
+        convertToCartesianBatch(src, dst, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            dst[i] = src[i] + origin_;
+        }
+    }
+    applyHomography(inverseHomography33_, dst, dst, count);
+    return true;
+}
+
 void HomographyMapper::drawCoordinateSystem(cv::Mat& frame) const {
     if (!calibrated_ || frame.empty()) {
         return;
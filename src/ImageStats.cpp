@@ -0,0 +1,110 @@
+#include "../include/ImageStats.h"
+#include <opencv2/core/version.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// 向量路径使用 v_add/v_sub 等函数形式的通用指令（OpenCV 4.8 起提供），更早的版本只用标量路径
+#define IMAGE_STATS_SIMD (CV_SIMD && (CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 8)))
+
+namespace {
+// 向量化累加时每段最多处理的列数，保证 32 位累加器在一段内不会溢出
+// （拉普拉斯响应在 [-1020, 1020]，每个通道每次迭代最多累加 4 个平方项）
+const int kSegmentWidth = 1024;
+
+struct StatsAccumulator {
+    int64_t sum = 0;
+    int64_t sumSquares = 0;
+    int64_t laplacianSum = 0;
+    int64_t laplacianSumSquares = 0;
+};
+
+// 标量路径：处理单个像素，left/right 为（按边界反射后的）左右邻居列
+inline void accumulatePixel(const uchar* above, const uchar* row, const uchar* below, int x, int left, int right,
+                            StatsAccumulator& acc) {
+    int value = row[x];
+    int laplacian = above[x] + below[x] + row[left] + row[right] - 4 * value;
+    acc.sum += value;
+    acc.sumSquares += value * value;
+    acc.laplacianSum += laplacian;
+    acc.laplacianSumSquares += laplacian * laplacian;
+}
+}
+
+GrayImageStats computeGrayImageStats(const cv::Mat& gray) {
+    CV_Assert(gray.type() == CV_8UC1);
+
+    GrayImageStats stats;
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+    if (rows == 0 || cols == 0) {
+        return stats;
+    }
+
+    StatsAccumulator acc;
+    for (int y = 0; y < rows; ++y) {
+        // BORDER_REFLECT_101：第 -1 行取第 1 行，第 rows 行取第 rows - 2 行
+        const uchar* row = gray.ptr<uchar>(y);
+        const uchar* above = gray.ptr<uchar>(rows > 1 ? (y > 0 ? y - 1 : 1) : 0);
+        const uchar* below = gray.ptr<uchar>(rows > 1 ? (y < rows - 1 ? y + 1 : rows - 2) : 0);
+
+        accumulatePixel(above, row, below, 0, cols > 1 ? 1 : 0, cols > 1 ? 1 : 0, acc);
+        int x = 1;
+
+#if IMAGE_STATS_SIMD
+        // 一次处理 CV_SIMD_WIDTH 个像素，需要右侧多读一列，因此最后一列留给标量路径
+        const int lanes = CV_SIMD_WIDTH;
+        const v_uint8 ones8 = vx_setall_u8(1);
+        const v_int16 ones16 = vx_setall_s16(1);
+        while (x + lanes < cols) {
+            const int segmentEnd = std::min(cols - 1 - lanes, x + kSegmentWidth);
+            v_uint32 sum = vx_setzero_u32();
+            v_uint32 sumSquares = vx_setzero_u32();
+            v_int32 laplacianSum = vx_setzero_s32();
+            v_int32 laplacianSumSquares = vx_setzero_s32();
+
+            for (; x <= segmentEnd; x += lanes) {
+                v_uint8 center = vx_load(row + x);
+                sum = v_add(sum, v_dotprod_expand(center, ones8));
+                sumSquares = v_add(sumSquares, v_dotprod_expand(center, center));
+
+                // 拉普拉斯 (上 + 下 + 左 + 右 - 4 * 中心) 在 int16 中计算
+                v_uint16 center0, center1, left0, left1, right0, right1, above0, above1, below0, below1;
+                v_expand(center, center0, center1);
+                v_expand(vx_load(row + x - 1), left0, left1);
+                v_expand(vx_load(row + x + 1), right0, right1);
+                v_expand(vx_load(above + x), above0, above1);
+                v_expand(vx_load(below + x), below0, below1);
+                v_int16 laplacian0 = v_sub(v_reinterpret_as_s16(v_add(v_add(above0, below0), v_add(left0, right0))),
+                                           v_reinterpret_as_s16(v_shl<2>(center0)));
+                v_int16 laplacian1 = v_sub(v_reinterpret_as_s16(v_add(v_add(above1, below1), v_add(left1, right1))),
+                                           v_reinterpret_as_s16(v_shl<2>(center1)));
+
+                laplacianSum = v_add(laplacianSum, v_add(v_dotprod(laplacian0, ones16), v_dotprod(laplacian1, ones16)));
+                laplacianSumSquares = v_add(laplacianSumSquares,
+                                            v_add(v_dotprod(laplacian0, laplacian0), v_dotprod(laplacian1, laplacian1)));
+            }
+
+            acc.sum += v_reduce_sum(sum);
+            acc.sumSquares += v_reduce_sum(sumSquares);
+            acc.laplacianSum += v_reduce_sum(laplacianSum);
+            acc.laplacianSumSquares += v_reduce_sum(laplacianSumSquares);
+        }
+#endif
+
+        for (; x < cols; ++x) {
+            accumulatePixel(above, row, below, x, x - 1, x < cols - 1 ? x + 1 : cols - 2, acc);
+        }
+    }
+#if IMAGE_STATS_SIMD
+    vx_cleanup();
+#endif
+
+    const double count = static_cast<double>(rows) * cols;
+    stats.mean = acc.sum / count;
+    stats.stddev = std::sqrt(std::max(0.0, acc.sumSquares / count - stats.mean * stats.mean));
+    const double laplacianMean = acc.laplacianSum / count;
+    stats.laplacianVariance = std::max(0.0, acc.laplacianSumSquares / count - laplacianMean * laplacianMean);
+    return stats;
+}
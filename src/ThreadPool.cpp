@@ -0,0 +1,97 @@
+#include "../include/ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount) {
+    for (int i = 1; i < threadCount; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(int taskCount, const std::function<void(int)>& task) {
+    if (taskCount <= 0) {
+        return;
+    }
+
+    // 没有工作线程或只有一个任务时直接在调用线程执行
+    if (workers_.empty() || taskCount == 1) {
+        for (int i = 0; i < taskCount; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> callLock(callMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        taskCount_ = taskCount;
+        nextTask_.store(0, std::memory_order_relaxed);
+        activeWorkers_ = static_cast<int>(workers_.size());
+        error_ = nullptr;
+        generation_++;
+    }
+    wake_.notify_all();
+
+    runTasks();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return activeWorkers_ == 0; });
+        task_ = nullptr;
+        error = error_;
+        error_ = nullptr;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::runTasks() {
+    for (int i = nextTask_.fetch_add(1, std::memory_order_relaxed); i < taskCount_;
+         i = nextTask_.fetch_add(1, std::memory_order_relaxed)) {
+        try {
+            (*task_)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seenGeneration] { return stopping_ || generation_ != seenGeneration; });
+            if (stopping_) {
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        runTasks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--activeWorkers_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+}
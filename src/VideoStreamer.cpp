@@ -4,10 +4,58 @@
 #include <chrono>
 #include <opencv2/imgcodecs.hpp>
 #include <sstream>
+#include <iomanip>
 
 using namespace std;
 using namespace std::chrono_literals;
 
+// 从JPEG的SOF段读取图像尺寸，避免为获取宽高而解码整帧
+static bool readJpegSize(const uchar* data, size_t size, int& width, int& height) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+    size_t pos = 2;
+    while (pos + 9 < size) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        uchar marker = data[pos + 1];
+        size_t segmentLength = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+        // SOF0-SOF15（排除DHT/JPG/DAC）
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            height = (data[pos + 5] << 8) | data[pos + 6];
+            width = (data[pos + 7] << 8) | data[pos + 8];
+            return width > 0 && height > 0;
+        }
+        pos += 2 + segmentLength;
+    }
+    return false;
+}
+
+// 自适应质量档位：档位越高，质量、分辨率和帧率越低
+struct QualityTier {
+    int quality;
+    double scale;
+    int frameSkip;
+};
+static const QualityTier kQualityTiers[] = {
+    {92, 1.0, 1},   // 局域网默认
+    {80, 1.0, 1},
+    {70, 0.75, 2},
+    {55, 0.5, 3}
+};
+
+// 档位切换阈值
+static const double kDegradeLatencyMs = 250.0;          // 确认延迟超过此值降档
+static const size_t kDegradeFramesInFlight = 6;         // 未确认帧数超过此值降档
+static const size_t kDegradeOutstandingBytes = 2 * 1024 * 1024;
+static const double kUpgradeLatencyMs = 80.0;           // 确认延迟低于此值且积压很少时考虑升档
+static const size_t kUpgradeFramesInFlight = 2;
+static const auto kDegradeHold = std::chrono::seconds(1);  // 两次降档的最小间隔，等待上一次降档生效
+static const auto kUpgradeHold = std::chrono::seconds(3);  // 状况持续良好多久后升档
+static const size_t kMaxTrackedFrames = 120;            // 每个连接最多记录的未确认帧数
+static const int kFrameInfoInterval = 100;              // 每隔多少帧重发一次 frame_info
+
 VideoStreamer::VideoStreamer() : width_(1920), height_(1080), fps_(30) {
     // 初始化
     // 注释掉自动加载标定数据的逻辑，让用户手动选择是否加载
@@ -26,6 +74,13 @@ VideoStreamer::VideoStreamer() : width_(1920), height_(1080), fps_(30) {
     displayHeight_ = 540;
     detectionWidth_ = 1920;  // 检测分辨率：高精度（将根据摄像头实际能力调整）
     detectionHeight_ = 1080;
+    
+    // 编码线程数：采集/处理/发送各占一个核心，其余核心中最多用4个做JPEG编码
+    unsigned int cores = std::thread::hardware_concurrency();
+    encoderThreadCount_ = cores > 4 ? std::min(4u, cores - 3) : 1;
+    
+    // 去畸变按行带并行，最多使用一半核心（与编码线程分担）
+    cameraCalibrator_.setUndistortThreadCount(static_cast<int>(std::max(1u, std::min(4u, cores / 2))));
 }
 
 VideoStreamer::~VideoStreamer() {
@@ -37,6 +92,16 @@ bool VideoStreamer::initialize(int camera_id, int width, int height, int fps) {
     if (cap_.isOpened()) {
         cap_.release();
     }
+    {
+        // 初始化时按当前选择的后端类型重新创建（恢复时不经过这里，沿用原对象）
+        std::lock_guard<std::mutex> lock(captureBackendMutex_);
+        captureBackend_.reset();
+    }
+    
+    // 使用独立采集后端（V4L2 mmap 或文件模拟设备）
+    if (captureBackendType_ != CaptureBackendType::OpenCV) {
+        return initializeCaptureBackend(camera_id, width, height, fps);
+    }
     
     // 如果指定了摄像头ID，则使用指定的摄像头
     if (camera_id >= 0) {
@@ -51,13 +116,16 @@ bool VideoStreamer::initialize(int camera_id, int width, int height, int fps) {
             std::cout << "Using simulation mode instead" << std::endl;
             
             // 创建一个模拟图像
-            frame_ = cv::Mat(height, width, CV_8UC3, cv::Scalar(200, 200, 200));
+            auto simulatedFrame = std::make_shared<Frame>();
+            simulatedFrame->image = cv::Mat(height, width, CV_8UC3, cv::Scalar(200, 200, 200));
+            simulatedFrame->timestamp = std::chrono::steady_clock::now();
             
             // 在图像上绘制文字
-            cv::putText(frame_, "Simulation Mode - No Camera", cv::Point(50, height/2 - 30), 
+            cv::putText(simulatedFrame->image, "Simulation Mode - No Camera", cv::Point(50, height/2 - 30), 
                         cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0, 0, 0), 2);
-            cv::putText(frame_, "Testing Matrix Display & Export", cv::Point(50, height/2 + 30), 
+            cv::putText(simulatedFrame->image, "Testing Matrix Display & Export", cv::Point(50, height/2 + 30), 
                         cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0, 0, 0), 2);
+            latestFrame_.publish(std::move(simulatedFrame));
             
             // 创建一个模拟的单应性矩阵
             cv::Mat simulatedMatrix = (cv::Mat_<double>(3, 3) << 
@@ -134,33 +202,85 @@ bool VideoStreamer::initialize(int camera_id, int width, int height, int fps) {
     try {
         cv::Mat testFrame;
         if (cap_.read(testFrame) && !testFrame.empty()) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            frame_ = testFrame.clone();
-            detectionFrame_ = testFrame.clone();
+            auto initialFrame = std::make_shared<Frame>();
+            initialFrame->image = testFrame;
+            initialFrame->timestamp = std::chrono::steady_clock::now();
+            latestFrame_.publish(std::move(initialFrame));
             std::cout << "✅ [MAT INIT] Mat objects initialized safely with dimensions: " 
                       << testFrame.cols << "x" << testFrame.rows << std::endl;
         } else {
             std::cerr << "⚠️ [MAT INIT] Unable to read initial frame for Mat initialization" << std::endl;
-            // 创建空的Mat对象避免未初始化状态
-            std::lock_guard<std::mutex> lock(mutex_);
-            frame_ = cv::Mat();
-            detectionFrame_ = cv::Mat();
+            // 发布空帧避免未初始化状态
+            latestFrame_.reset();
         }
     } catch (const cv::Exception& e) {
         std::cerr << "❌ [MAT INIT] OpenCV error during Mat initialization: " << e.what() << std::endl;
-        std::lock_guard<std::mutex> lock(mutex_);
-        frame_ = cv::Mat();
-        detectionFrame_ = cv::Mat();
+        latestFrame_.reset();
     } catch (const std::exception& e) {
         std::cerr << "❌ [MAT INIT] Error during Mat initialization: " << e.what() << std::endl;
-        std::lock_guard<std::mutex> lock(mutex_);
-        frame_ = cv::Mat();
-        detectionFrame_ = cv::Mat();
+        latestFrame_.reset();
     }
 
     return true;
 }
 
+void VideoStreamer::setCaptureBackend(CaptureBackendType type, const std::string& device, int bufferCount,
+                                     CapturePixelFormat format) {
+    captureBackendType_ = type;
+    captureDevice_ = device;
+    captureBufferCount_ = std::max(2, bufferCount);
+    captureFormat_ = format;
+}
+
+CaptureBackendType VideoStreamer::getCaptureBackendType() const {
+    return captureBackendType_;
+}
+
+bool VideoStreamer::initializeCaptureBackend(int camera_id, int width, int height, int fps) {
+    CaptureConfig config;
+    config.device = captureDevice_;
+    if (config.device.empty()) {
+        config.device = "/dev/video" + std::to_string(camera_id >= 0 ? camera_id : 0);
+    }
+    config.width = width;
+    config.height = height;
+    config.fps = fps;
+    config.format = captureFormat_;
+    config.bufferCount = captureBufferCount_;
+    
+    std::lock_guard<std::mutex> lock(captureBackendMutex_);
+    if (captureBackend_) {
+        captureBackend_->close();
+    }
+    if (!captureBackend_) {
+        captureBackend_ = CaptureBackend::create(captureBackendType_);
+    }
+    // 打开失败时保留（已关闭的）后端对象，之后的恢复仍使用同一种后端，不会退回到未打开的 cap_
+    if (!captureBackend_ || !captureBackend_->open(config)) {
+        std::cerr << "Error: Could not open capture backend on " << config.device << std::endl;
+        return false;
+    }
+    
+    captureDevice_ = config.device;
+    captureConfig_ = config;
+    cv::Size size = captureBackend_->frameSize();
+    width_ = size.width;
+    height_ = size.height;
+    fps_ = fps;
+    detectionWidth_ = size.width;
+    detectionHeight_ = size.height;
+    
+    std::cout << "📹 [CAPTURE BACKEND] " << captureBackend_->name() << ": " << config.device << " "
+              << width_ << "x" << height_ << "@" << fps_ << "fps, "
+              << captureBackend_->bufferCount() << " buffers" << std::endl;
+    return true;
+}
+
+bool VideoStreamer::isCaptureOpened() const {
+    std::lock_guard<std::mutex> lock(captureBackendMutex_);
+    return captureBackend_ ? captureBackend_->isOpened() : cap_.isOpened();
+}
+
 bool VideoStreamer::autoDetectCamera() {
     // 尝试直接使用设备路径打开摄像头
     std::vector<std::string> device_paths = {
@@ -240,9 +360,12 @@ std::vector<std::pair<int, int>> VideoStreamer::getSupportedResolutions() {
         {640, 480}     // VGA - 兼容性保留
     };
     
-    // 如果摄像头未打开，返回默认列表
-    if (!cap_.isOpened()) {
-        return resolutions;
+    // 如果摄像头未打开或使用独立采集后端，返回默认列表
+    {
+        std::lock_guard<std::mutex> lock(captureBackendMutex_);
+        if (captureBackend_ || !cap_.isOpened()) {
+            return resolutions;
+        }
     }
     
     // 验证摄像头支持的分辨率
@@ -277,6 +400,14 @@ std::vector<std::pair<int, int>> VideoStreamer::getSupportedResolutions() {
 }
 
 bool VideoStreamer::setResolution(int width, int height) {
+    if (captureBackendType_ != CaptureBackendType::OpenCV) {
+        // 独立后端的缓冲区按分辨率分配，需要在停止状态下重新初始化
+        if (running_) {
+            cerr << "Error: Stop the stream before changing resolution on the capture backend" << endl;
+            return false;
+        }
+        return initializeCaptureBackend(-1, width, height, fps_);
+    }
     if (!cap_.isOpened()) {
         cerr << "Error: Camera not initialized" << endl;
         return false;
@@ -301,6 +432,13 @@ bool VideoStreamer::setResolution(int width, int height) {
 }
 
 std::pair<int, int> VideoStreamer::getCurrentResolution() {
+    {
+        std::lock_guard<std::mutex> lock(captureBackendMutex_);
+        if (captureBackend_) {
+            cv::Size size = captureBackend_->frameSize();
+            return {size.width, size.height};
+        }
+    }
     if (!cap_.isOpened()) {
         return {width_, height_}; // 返回内部存储的分辨率
     }
@@ -313,84 +451,139 @@ std::pair<int, int> VideoStreamer::getCurrentResolution() {
 }
 
 void VideoStreamer::start() {
-    if (!cap_.isOpened()) {
+    if (!isCaptureOpened()) {
         cerr << "Error: Camera not initialized" << endl;
         return;
     }
     
     running_ = true;
-    worker_ = thread(&VideoStreamer::captureThread, this);
     
-    // 性能优化：启动广播线程时添加帧率控制
-    thread broadcast_thread([this]() {
-        // 高性能模式 - 使用原始FPS设置，不进行降速
-        int targetFPS = fps_;
-        
-        std::cout << "🚀 [HIGH PERFORMANCE MODE] Target FPS: " << targetFPS << " (High frame rate mode enabled)" << std::endl;
-        
-        auto lastFrameTime = std::chrono::high_resolution_clock::now();
-        auto targetFrameInterval = std::chrono::microseconds(1000000 / targetFPS); // 目标帧间隔
-        
-        // 性能监控变量
-        int broadcastCount = 0;
-        auto performanceReportTime = std::chrono::steady_clock::now();
-        
-        while (running_) {
-            auto frameStart = std::chrono::high_resolution_clock::now();
-            
-            // 执行帧广播
-            broadcastFrame();
-            broadcastCount++;
-            
-            auto frameEnd = std::chrono::high_resolution_clock::now();
-            
-            // 精确的帧率控制 - 只在必要时睡眠
-            auto elapsedSinceLastFrame = frameEnd - lastFrameTime;
-            auto sleepTime = targetFrameInterval - elapsedSinceLastFrame;
-            
-            if (sleepTime > std::chrono::microseconds(100)) { // 只有超过100微秒才睡眠
-                std::this_thread::sleep_for(sleepTime);
-            } else {
-                // 使用yield让出CPU时间片，但不强制睡眠
-                std::this_thread::yield();
-            }
-            
-            lastFrameTime = std::chrono::high_resolution_clock::now();
-            
-            // 每10秒输出一次性能报告
-            auto broadcastReportTime = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::seconds>(broadcastReportTime - performanceReportTime).count() >= 10) {
-                double actualFPS = broadcastCount / 10.0;
-                std::cout << "🎯 [HIGH PERFORMANCE] Actual FPS: " << std::fixed << std::setprecision(2) << actualFPS 
-                          << " (Target: " << targetFPS << ")" << std::endl;
-                
-                // 重置计数器
-                broadcastCount = 0;
-                performanceReportTime = broadcastReportTime;
-            }
-        }
-    });
-    broadcast_thread.detach();
+    // 流水线：采集 → 处理 → 编码 → 发送，各阶段运行在独立线程上，
+    // 通过有界无锁队列衔接，队列满时丢弃最旧的帧
+    worker_ = thread(&VideoStreamer::captureThread, this);
+    processWorker_ = thread(&VideoStreamer::processThread, this);
+    startEncodeAndSendWorkers();
     
+    std::cout << "🚀 [HIGH PERFORMANCE MODE] Target FPS: " << fps_ << " (pipelined capture/process/encode/send, "
+              << encoderThreadCount_ << " encoder threads)" << std::endl;
     cout << "Video stream started" << endl;
 }
 
+void VideoStreamer::startEncodeAndSendWorkers() {
+    for (int i = 0; i < encoderThreadCount_; ++i) {
+        encodeWorkers_.emplace_back(&VideoStreamer::encodeThread, this);
+    }
+    sendWorker_ = thread(&VideoStreamer::sendThread, this);
+}
+
+bool VideoStreamer::startOffline(int width, int height, int fps) {
+    if (running_) {
+        cerr << "Error: Video stream is already running" << endl;
+        return false;
+    }
+    if (width <= 0 || height <= 0) {
+        cerr << "Error: Invalid offline frame size " << width << "x" << height << endl;
+        return false;
+    }
+    
+    width_ = width;
+    height_ = height;
+    fps_ = fps;
+    detectionWidth_ = width;
+    detectionHeight_ = height;
+    running_ = true;
+    
+    // 没有采集线程和处理线程，处理阶段由 submitOfflineFrame() 的调用线程承担
+    startEncodeAndSendWorkers();
+    
+    std::cout << "🚀 [OFFLINE MODE] " << width_ << "x" << height_ << "@" << fps_ << "fps ("
+              << encoderThreadCount_ << " encoder threads)" << std::endl;
+    return true;
+}
+
+bool VideoStreamer::submitOfflineFrame(cv::Mat frame) {
+    if (!running_ || worker_.joinable() || processWorker_.joinable()) {
+        cerr << "Error: submitOfflineFrame() requires startOffline()" << endl;
+        return false;
+    }
+    if (frame.empty() || frame.type() != CV_8UC3) {
+        cerr << "Error: Offline frames must be non-empty BGR images" << endl;
+        return false;
+    }
+    
+    // 与采集线程交给处理阶段的帧相同，之后的处理与处理线程完全一致
+    CapturedFrame captured;
+    captured.format = CapturePixelFormat::BGR;
+    captured.image = std::move(frame);
+    captured.sequence = offlineSequence_++;
+    captured.captureTime = std::chrono::steady_clock::now();
+    capturedFrames_++;
+    
+    if (!processCapturedFrame(captured)) {
+        return false;
+    }
+    captured.image.release();
+    processedFrames_++;
+    broadcastFrame();
+    return true;
+}
+
+void VideoStreamer::setDeliveryObserver(DeliveryObserver observer) {
+    if (running_) {
+        cerr << "Error: Set the delivery observer before starting the stream" << endl;
+        return;
+    }
+    deliveryObserver_ = std::move(observer);
+}
+
+void VideoStreamer::setBroadcastObserver(BroadcastObserver observer) {
+    if (running_) {
+        cerr << "Error: Set the broadcast observer before starting the stream" << endl;
+        return;
+    }
+    broadcastObserver_ = std::move(observer);
+}
+
 void VideoStreamer::stop() {
     if (running_) {
         running_ = false;
-        if (worker_.joinable()) {
-            worker_.join();
+        for (std::thread* stage : {&worker_, &processWorker_, &sendWorker_}) {
+            if (stage->joinable()) {
+                stage->join();
+            }
+        }
+        for (auto& encoder : encodeWorkers_) {
+            if (encoder.joinable()) {
+                encoder.join();
+            }
         }
+        encodeWorkers_.clear();
     }
     
+    // 清空流水线中残留的帧
+    captureQueue_.clear();
+    encodeQueue_.clear();
+    sendQueue_.clear();
+    abandonedSequences_.clear();
+    
     {
+        // 连接状态和计数随连接一起清除，否则重新启动后仍按已断开的连接选择档位、强制重新编码
         std::lock_guard<std::mutex> lock(conn_mutex_);
         connections_.clear();
+        clientStates_.clear();
+        degradedClients_ = 0;
+        birdsEyeClients_ = 0;
     }
     
     if (cap_.isOpened()) {
         cap_.release();
     }
+    {
+        std::lock_guard<std::mutex> lock(captureBackendMutex_);
+        if (captureBackend_) {
+            captureBackend_->close();
+        }
+    }
     
     cout << "Video streaming stopped" << endl;
 }
@@ -400,9 +593,14 @@ void VideoStreamer::handleWebSocket(const crow::request& req, Connection conn) {
     {
         std::lock_guard<std::mutex> lock(conn_mutex_);
         connections_.insert(conn);
+        ClientState& state = clientStates_[conn];
+        state.lastTierChange = std::chrono::steady_clock::now();
         std::cout << "WebSocket connection added to VideoStreamer, total connections: " << connections_.size() << std::endl;
     }
     
+    // 新客户端需要完整画面才能合成分块更新
+    tileKeyframePending_ = true;
+    
     // 发送摄像头信息给客户端
     sendCameraInfo(conn);
 }
@@ -410,6 +608,16 @@ void VideoStreamer::handleWebSocket(const crow::request& req, Connection conn) {
 void VideoStreamer::removeWebSocketConnection(Connection conn) {
     std::lock_guard<std::mutex> lock(conn_mutex_);
     auto it = connections_.find(conn);
+    auto stateIt = clientStates_.find(conn);
+    if (stateIt != clientStates_.end()) {
+        if (stateIt->second.tier > 0) {
+            degradedClients_--;
+        }
+        if (stateIt->second.view == VideoView::BirdsEye) {
+            birdsEyeClients_--;
+        }
+        clientStates_.erase(stateIt);
+    }
     if (it != connections_.end()) {
         connections_.erase(it);
         std::cout << "WebSocket connection removed from VideoStreamer, remaining connections: " << connections_.size() << std::endl;
@@ -471,7 +679,9 @@ void VideoStreamer::sendCameraInfo(Connection conn) {
 
 // 单应性矩阵标定相关方法的实现
 bool VideoStreamer::addCalibrationPoint(const cv::Point2f& imagePoint, const cv::Point2f& groundPoint) {
-    homographyMapper_.addCalibrationPoint(imagePoint, groundPoint);
+    // 画面未整帧去畸变时，只校正点击的这一个点
+    cv::Point2f correctedPoint = isPointCorrectionActive() ? cameraCalibrator_.undistortPoint(imagePoint) : imagePoint;
+    homographyMapper_.addCalibrationPoint(correctedPoint, groundPoint);
     return true;
 }
 
@@ -509,11 +719,24 @@ bool VideoStreamer::loadHomography(const std::string& filename) {
 }
 
 cv::Point2f VideoStreamer::imageToGround(const cv::Point2f& imagePoint) {
+    if (isPointCorrectionActive()) {
+        return homographyMapper_.imageToGround(cameraCalibrator_.undistortPoint(imagePoint));
+    }
     return homographyMapper_.imageToGround(imagePoint);
 }
 
+void VideoStreamer::enableGroundLookupTable(int cellSize) {
+    // 缓存文件名带上分辨率和网格间距，切换参数时不会互相覆盖
+    std::string directory = calibrationFilePath_.substr(0, calibrationFilePath_.find_last_of('/') + 1);
+    std::string cachePath = directory + "ground_lut_" + std::to_string(width_) + "x" + std::to_string(height_) +
+                            "_c" + std::to_string(cellSize) + ".bin";
+    homographyMapper_.enableGroundLookupTable(cv::Size(width_, height_), cellSize, cachePath);
+}
+
 cv::Point2f VideoStreamer::groundToImage(const cv::Point2f& groundPoint) {
-    return homographyMapper_.groundToImage(groundPoint);
+    // 单应性矩阵工作在无畸变坐标中，画面未去畸变时映射回原始图像坐标
+    cv::Point2f imagePoint = homographyMapper_.groundToImage(groundPoint);
+    return isPointCorrectionActive() ? cameraCalibrator_.distortPoint(imagePoint) : imagePoint;
 }
 
 bool VideoStreamer::isCalibrated() const {
@@ -531,6 +754,9 @@ cv::Mat VideoStreamer::getHomographyMatrix() const {
 // ArUco 标记相关方法实现
 bool VideoStreamer::toggleArUcoMode() {
     arucoMode_ = !arucoMode_;
+    // 切换时丢弃后台检测的旧结果，重新启用时不会绘制过时的标记
+    arucoWorker_.reset();
+    arucoResultAgeFrames_ = -1;
     return arucoMode_;
 }
 
@@ -538,21 +764,49 @@ bool VideoStreamer::isArUcoMode() const {
     return arucoMode_;
 }
 
-bool VideoStreamer::detectArUcoMarkers(cv::Mat& frame) {
-    if (!arucoMode_) return false;
+void VideoStreamer::drawArUcoDetections(cv::Mat& frame, const Frame& source) {
+    ArUcoDetectionResultPtr result = arucoWorker_.latest();
+    if (!result) {
+        arucoResultAgeFrames_ = -1;
+        return;
+    }
     
-    // 检测标记
-    std::vector<int> markerIds;
-    std::vector<std::vector<cv::Point2f>> markerCorners;
+    // 结果年龄：当前帧与检测所用帧之间的采集帧数和时间
+    arucoResultAgeFrames_ = source.sequence > result->sequence ? static_cast<int64_t>(source.sequence - result->sequence) : 0;
+    arucoResultAgeMs_ = std::max(0.0, std::chrono::duration<double, std::milli>(source.timestamp - result->timestamp).count());
     
-    bool detected = homographyMapper_.detectArUcoMarkers(frame, markerIds, markerCorners);
+    // 每个新结果只检查一次是否需要通知前端
+    if (result != arucoNotifiedResult_) {
+        arucoNotifiedResult_ = result;
+        notifyArUcoDetection(*result);
+    }
+    if (result->markerIds.empty()) {
+        return;
+    }
     
+    // 检测所用帧与当前绘制的帧分辨率不同（如相机标定模式下的显示分辨率）时按比例换算角点
+    if (frame.size() == result->imageSize) {
+        homographyMapper_.drawDetectedMarkers(frame, result->markerIds, result->markerCorners);
+    } else {
+        const float sx = static_cast<float>(frame.cols) / result->imageSize.width;
+        const float sy = static_cast<float>(frame.rows) / result->imageSize.height;
+        std::vector<std::vector<cv::Point2f>> corners = result->markerCorners;
+        for (auto& marker : corners) {
+            for (auto& corner : marker) {
+                corner.x *= sx;
+                corner.y *= sy;
+            }
+        }
+        homographyMapper_.drawDetectedMarkers(frame, result->markerIds, corners);
+    }
+}
+
+void VideoStreamer::notifyArUcoDetection(const ArUcoDetectionResult& result) {
     // 发送实时检测结果给前端
-    static int lastMarkerCount = -1;
-    int currentMarkerCount = markerIds.size();
+    int currentMarkerCount = result.markerIds.size();
     
     // 只有当检测到的标记数量发生变化时才发送更新（避免频繁发送）
-    if (currentMarkerCount != lastMarkerCount) {
+    if (currentMarkerCount != arucoNotifiedMarkerCount_) {
         // 构建检测结果消息，包含详细的标记信息
         bool homographyLoaded = !getHomographyMatrix().empty();
         std::stringstream aruco_message;
@@ -564,12 +818,12 @@ bool VideoStreamer::detectArUcoMarkers(cv::Mat& frame) {
         // 如果检测到标记，添加详细信息
         if (currentMarkerCount > 0) {
             aruco_message << ",\"markers\":[";
-            for (size_t i = 0; i < markerIds.size(); i++) {
-                int id = markerIds[i];
+            for (size_t i = 0; i < result.markerIds.size(); i++) {
+                int id = result.markerIds[i];
                 
                 // 计算标记中心
                 cv::Point2f center(0, 0);
-                for (const auto& corner : markerCorners[i]) {
+                for (const auto& corner : result.markerCorners[i]) {
                     center += corner;
                 }
                 center *= 0.25f;
@@ -584,7 +838,7 @@ bool VideoStreamer::detectArUcoMarkers(cv::Mat& frame) {
                 }
                 
                 aruco_message << "}";
-                if (i < markerIds.size() - 1) aruco_message << ",";
+                if (i < result.markerIds.size() - 1) aruco_message << ",";
             }
             aruco_message << "]";
         }
@@ -605,27 +859,48 @@ bool VideoStreamer::detectArUcoMarkers(cv::Mat& frame) {
             }
         }
         
-        lastMarkerCount = currentMarkerCount;
+        arucoNotifiedMarkerCount_ = currentMarkerCount;
         std::cout << "[ArUco 检测] 更新: 检测到 " << currentMarkerCount << " 个标记，矩阵状态: " 
                   << (homographyLoaded ? "已标定" : "未标定") << std::endl;
     }
-    
-    if (detected) {
-        // 绘制检测到的标记（HomographyMapper会处理所有显示信息）
-        homographyMapper_.drawDetectedMarkers(frame, markerIds, markerCorners);
+}
+
+void VideoStreamer::setArUcoDetectionRate(double detectionsPerSecond) {
+    arucoWorker_.setMaxRate(detectionsPerSecond);
+    std::cout << "[ArUco 参数] 后台检测频率上限: ";
+    if (detectionsPerSecond > 0) {
+        std::cout << detectionsPerSecond << " 次/秒" << std::endl;
+    } else {
+        std::cout << "不限" << std::endl;
     }
-    
-    return detected;
+}
+
+VideoStreamer::ArUcoDetectionStatus VideoStreamer::getArUcoDetectionStatus() const {
+    ArUcoDetectionWorker::Stats stats = arucoWorker_.getStats();
+    ArUcoDetectionStatus status;
+    status.maxRate = stats.maxRate;
+    status.detections = stats.detections;
+    status.replacedFrames = stats.replacedFrames;
+    status.lastDetectMs = stats.lastDetectMs;
+    status.averageDetectMs = stats.averageDetectMs;
+    status.resultAgeFrames = arucoResultAgeFrames_;
+    status.resultAgeMs = arucoResultAgeMs_;
+    return status;
 }
 
 bool VideoStreamer::calibrateFromArUcoMarkers() {
     if (!arucoMode_) return false;
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (frame_.empty()) return false;
+    FramePtr current = currentFrame();
+    if (!current || current->image.empty()) return false;
     
-    // 使用当前帧和标记地面坐标进行标定
-    return homographyMapper_.calibrateFromArUcoMarkers(frame_, homographyMapper_.getMarkerGroundCoordinates());
+    // 使用当前帧和标记地面坐标进行标定；画面未去畸变时只校正标记中心
+    std::lock_guard<std::mutex> lock(arucoDetectMutex_);
+    if (isPointCorrectionActive()) {
+        return homographyMapper_.calibrateFromArUcoMarkers(current->image, homographyMapper_.getMarkerGroundCoordinates(),
+                                                           getCameraMatrix(), getDistCoeffs());
+    }
+    return homographyMapper_.calibrateFromArUcoMarkers(current->image, homographyMapper_.getMarkerGroundCoordinates());
 }
 
 bool VideoStreamer::setMarkerGroundCoordinates(int markerId, const cv::Point2f& groundCoord) {
@@ -646,6 +921,13 @@ bool VideoStreamer::loadMarkerCoordinates(const std::string& filename) {
 void VideoStreamer::drawCalibrationPoints(cv::Mat& frame) {
     auto points = homographyMapper_.getCalibrationPoints();
     
+    // 标定点保存的是无畸变坐标，画面未去畸变时换算回原始图像坐标再绘制
+    if (isPointCorrectionActive()) {
+        for (auto& point : points) {
+            point.first = cameraCalibrator_.distortPoint(point.first);
+        }
+    }
+    
     // 绘制标定点
     for (size_t i = 0; i < points.size(); ++i) {
         // 绘制外圈
@@ -782,22 +1064,22 @@ void VideoStreamer::drawCalibrationPoints(cv::Mat& frame) {
     cv::putText(frame, "Points: " + std::to_string(points.size()), cv::Point(10, 90), cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 123, 0), 2); // 蓝色 (0, 123, 255) 表示信息
 }
 
-void VideoStreamer::broadcastFrame() {
-    static int frame_count = 0;  // 静态帧计数器
+bool VideoStreamer::acquireBroadcastSlot(size_t& connectionCount) {
     static auto lastBroadcastTime = std::chrono::steady_clock::now();
     static int skippedFrames = 0;
     
     // 严格的连接检查 - 在任何Mat操作之前进行
     {
         std::lock_guard<std::mutex> conn_lock(conn_mutex_);
-        if (connections_.empty()) {
-            return; // 没有连接时直接返回，避免不必要的处理
-        }
+        connectionCount = connections_.size();
+    }
+    if (connectionCount == 0) {
+        return false; // 没有连接时直接返回，避免不必要的处理
     }
     
     // 检查运行状态
     if (!running_) {
-        return;
+        return false;
     }
     
     // 帧率控制逻辑
@@ -806,69 +1088,71 @@ void VideoStreamer::broadcastFrame() {
     
     // 动态帧率控制：根据连接数调整
     int targetInterval;
-    {
-        std::lock_guard<std::mutex> conn_lock(conn_mutex_);
-        if (connections_.size() <= 1) {
-            targetInterval = 33; // ~30 FPS for single connection
-        } else if (connections_.size() <= 2) {
-            targetInterval = 40; // ~25 FPS for 2 connections
-        } else {
-            targetInterval = 50; // ~20 FPS for 3+ connections
-        }
+    if (connectionCount <= 1) {
+        targetInterval = 33; // ~30 FPS for single connection
+    } else if (connectionCount <= 2) {
+        targetInterval = 40; // ~25 FPS for 2 connections
+    } else {
+        targetInterval = 50; // ~20 FPS for 3+ connections
     }
     
     if (timeSinceLastBroadcast.count() < targetInterval) {
         skippedFrames++;
-        return;
+        return false;
     }
     
     skippedFrames = 0;
     lastBroadcastTime = currentTime;
-    
-    // 性能监控：广播开始时间
-    auto broadcastStart = std::chrono::high_resolution_clock::now();
-    
-    // 再次检查连接状态（双重检查）
-    {
-        std::lock_guard<std::mutex> conn_lock(conn_mutex_);
-        if (connections_.empty()) {
-            return;
-        }
-    }
+    return true;
+}
 
+void VideoStreamer::broadcastFrame() {
+    size_t connectionCount;
+    if (!acquireBroadcastSlot(connectionCount)) {
+        return;
+    }
+    
     cv::Mat processedFrame;
+    cv::Mat birdsEyeFrame;  // 与原始画面同一采集帧生成的鸟瞰视图，只读共享
+    FramePtr snapshot;      // 本次广播所用的帧，用于计算叠加的检测结果的年龄
     
     // 性能监控：帧获取时间
     auto frameGetStart = std::chrono::high_resolution_clock::now();
     
+    // 只有需要绘制叠加层时才复制像素，否则直接编码共享的只读快照
+    bool needsOverlay = calibrationMode_ || arucoMode_;
+    
     // 根据模式选择合适的帧分辨率 - 添加异常处理
     try {
-        if (cameraCalibrationMode_) {
-            // 相机标定模式：使用优化的显示帧（已包含角点绘制）
-            processedFrame = getDisplayFrame();
-            if (processedFrame.empty()) {
-                std::cerr << "Warning: getDisplayFrame() returned empty frame in calibration mode" << std::endl;
-                return;
-            }
+        snapshot = currentFrame();
+        if (!snapshot || snapshot->image.empty() || snapshot->image.cols <= 0 || snapshot->image.rows <= 0) {
+            std::cerr << "Warning: latest frame is empty or invalid" << std::endl;
+            return;
+        }
+        
+        birdsEyeFrame = snapshot->birdsEye;
+        
+        // 验证Mat对象的有效性
+        const cv::Mat& latest = snapshot->image;
+        if (latest.type() != CV_8UC3 && latest.type() != CV_8UC1) {
+            std::cerr << "Warning: latest frame has invalid type: " << latest.type() << std::endl;
+            return;
+        }
+        
+        if (cameraCalibrationMode_ && (latest.cols != displayWidth_ || latest.rows != displayHeight_)) {
+            // 相机标定模式：使用显示分辨率的帧（已包含角点绘制），缩放结果本身就是独立的缓冲区
+            processedFrame = FramePool::instance().acquire(cv::Size(displayWidth_, displayHeight_), latest.type());
+            cv::resize(latest, processedFrame, cv::Size(displayWidth_, displayHeight_));
+        } else if (needsOverlay) {
+            processedFrame = FramePool::instance().acquire(latest.size(), latest.type());
+            latest.copyTo(processedFrame);
         } else {
-            // 普通模式：使用原始帧 - 添加更严格的检查
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (frame_.empty() || frame_.cols <= 0 || frame_.rows <= 0) {
-                std::cerr << "Warning: frame_ is empty or invalid in normal mode" << std::endl;
-                return;
-            }
-            
-            // 验证Mat对象的有效性
-            if (frame_.type() != CV_8UC3 && frame_.type() != CV_8UC1) {
-                std::cerr << "Warning: frame_ has invalid type: " << frame_.type() << std::endl;
-                return;
-            }
-            
-            processedFrame = frame_.clone();
-            if (processedFrame.empty()) {
-                std::cerr << "Warning: frame_.clone() failed" << std::endl;
-                return;
-            }
+            processedFrame = latest;  // 共享只读数据，编码阶段只读取
+        }
+        
+        if (processedFrame.empty()) {
+            std::cerr << "Warning: frame acquisition failed" << std::endl;
+            return;
         }
     } catch (const cv::Exception& e) {
         std::cerr << "OpenCV error in frame acquisition: " << e.what() << std::endl;
@@ -906,9 +1190,9 @@ void VideoStreamer::broadcastFrame() {
             drawCalibrationPoints(processedFrame);
         }
         
-        // 如果在ArUco模式下，检测并绘制ArUco标记
-        if (arucoMode_) {
-            detectArUcoMarkers(processedFrame);
+        // 如果在ArUco模式下，绘制后台检测的最新结果（不等待检测）
+        if (arucoMode_ && snapshot) {
+            drawArUcoDetections(processedFrame, *snapshot);
         }
     } catch (const cv::Exception& e) {
         std::cerr << "OpenCV error in frame processing: " << e.what() << std::endl;
@@ -920,6 +1204,11 @@ void VideoStreamer::broadcastFrame() {
     
     auto processingEnd = std::chrono::high_resolution_clock::now();
     double processingTime = std::chrono::duration<double, std::milli>(processingEnd - processingStart).count();
+    frameGetTimer_.add(frameGetTime);
+    overlayTimer_.add(processingTime);
+    if (broadcastObserver_) {
+        broadcastObserver_(frameGetTime, processingTime);
+    }
     
     // 在编码前进一步验证帧的有效性
     if (processedFrame.type() != CV_8UC3 && processedFrame.type() != CV_8UC1) {
@@ -927,190 +1216,801 @@ void VideoStreamer::broadcastFrame() {
         return;
     }
     
-    // 验证帧是否连续
-    if (!processedFrame.isContinuous()) {
-        // 如果不连续，创建一个连续的副本
-        try {
-            processedFrame = processedFrame.clone();
-        } catch (const cv::Exception& e) {
-            std::cerr << "OpenCV error making frame continuous for encoding: " << e.what() << std::endl;
+    // 编码队列已满说明编码跟不上，关闭JPEG优化以加快编码
+    bool fastMode = encodeQueue_.size() >= encodeQueue_.capacity();
+    
+    // 分块传输或关闭自适应质量时，所有连接共用一路最高档位的流（鸟瞰视图另成一路，不分块）
+    if (tiledStreaming_ || !adaptiveQualityEnabled_) {
+        if (!birdsEyeFrame.empty()) {
+            BroadcastJob birdsEyeJob;
+            birdsEyeJob.image = birdsEyeFrame;
+            birdsEyeJob.quality = kQualityTiers[0].quality;
+            birdsEyeJob.fastMode = fastMode;
+            birdsEyeJob.birdsEye = true;
+            birdsEyeJob.captureTime = snapshot->timestamp;
+            birdsEyeJob.sequence = broadcastSequence_++;
+            pushEncodeJob(std::move(birdsEyeJob));
+        }
+        if (birdsEyeClients_ >= static_cast<int>(connectionCount)) {
+            return;  // 所有连接都在看鸟瞰视图
+        }
+        
+        BroadcastJob job;
+        job.image = processedFrame;
+        job.quality = kQualityTiers[0].quality;
+        job.fastMode = fastMode;
+        job.captureTime = snapshot->timestamp;
+        
+        // 分块模式：只编码变化的块，画面静止时本帧不发送
+        if (tiledStreaming_ && !prepareTileUpdate(processedFrame, job)) {
             return;
         }
-    }
-    
-    // 性能监控：JPEG编码时间
-    auto encodeStart = std::chrono::high_resolution_clock::now();
-    
-    // 将帧编码为JPEG，使用优化的参数减少编码时间
-    std::vector<uchar> buf;
-    
-    // 局域网环境优化：使用更高的JPEG质量，确保图像清晰度
-    int jpegQuality = 92;  // 局域网环境使用高质量
-    bool fastMode = false;
-    
-    // 检查是否需要启用快速模式（仅在极端情况下）
-    static auto lastOverrunTime = std::chrono::steady_clock::now();
-    static int overrunCount = 0;
-    
-    auto now = std::chrono::steady_clock::now();
-    if (std::chrono::duration_cast<std::chrono::seconds>(now - lastOverrunTime).count() < 5) {
-        overrunCount++;
-        if (overrunCount > 5) { // 提高阈值：5秒内超过5次超时才启用快速模式
-            fastMode = true;
-            jpegQuality = 75;  // 即使在快速模式下也保持较高质量
+        
+        job.sequence = broadcastSequence_++;
+        if (!pushEncodeJob(std::move(job)) && tiledStreaming_) {
+            tileKeyframePending_ = true;  // 丢弃的块更新无法补发，下一帧发送关键帧
         }
-    } else {
-        overrunCount = 0;
-        lastOverrunTime = now;
-    }
-    
-    // 根据连接数轻微调整质量（局域网环境下影响较小）
-    if (connections_.size() > 2) {
-        jpegQuality = std::max(80, jpegQuality - 5 * (int)(connections_.size() - 2));
-    }
-    
-    std::vector<int> encode_params = {
-        cv::IMWRITE_JPEG_QUALITY, jpegQuality,
-        cv::IMWRITE_JPEG_OPTIMIZE, fastMode ? 0 : 1,  // 快速模式禁用优化
-        cv::IMWRITE_JPEG_PROGRESSIVE, 0  // 禁用渐进式JPEG以加快编码
-    };
-    
-    // 保持双分辨率设计：直接使用处理后的帧进行编码
-    // 局域网环境下不需要额外降采样
-    cv::Mat encodeFrame = processedFrame;
-    
-    bool encode_success = false;
-    try {
-        encode_success = cv::imencode(".jpg", encodeFrame, buf, encode_params);
-    } catch (const cv::Exception& e) {
-        std::cerr << "OpenCV error in JPEG encoding: " << e.what() << std::endl;
-        return;
-    } catch (const std::exception& e) {
-        std::cerr << "Error in JPEG encoding: " << e.what() << std::endl;
         return;
     }
     
-    auto encodeEnd = std::chrono::high_resolution_clock::now();
-    double encodeTime = std::chrono::duration<double, std::milli>(encodeEnd - encodeStart).count();
-    
-    // 检查编码是否成功
-    if (!encode_success || buf.empty()) {
-        std::cerr << "Warning: JPEG encoding failed, skipping frame transmission" << std::endl;
-        return;
+    // 每个有连接的档位、每种视图编码一次（按档位跳帧），交给编码阶段；编码队列满时丢弃最旧的待编码帧
+    bool cameraTiers[kQualityTierCount] = {};
+    bool birdsEyeTiers[kQualityTierCount] = {};
+    activeQualityTiers(cameraTiers, birdsEyeTiers);
+    for (int tier = 0; tier < kQualityTierCount; tier++) {
+        if (!cameraTiers[tier] && !birdsEyeTiers[tier]) {
+            continue;
+        }
+        const QualityTier& settings = kQualityTiers[tier];
+        if (tierFrameCounters_[tier]++ % settings.frameSkip != 0) {
+            continue;
+        }
+        
+        if (cameraTiers[tier]) {
+            BroadcastJob job;
+            job.image = processedFrame;
+            job.quality = settings.quality;
+            job.fastMode = fastMode;
+            job.tier = tier;
+            // 档位缩放相对采集分辨率；已校正为显示分辨率的帧不再放大
+            // 标定点击坐标按原始分辨率换算，标定模式下不缩放
+            job.scale = calibrationMode_ ? 1.0 : std::min(1.0, settings.scale * width_ / processedFrame.cols);
+            job.captureTime = snapshot->timestamp;
+            job.sequence = broadcastSequence_++;
+            pushEncodeJob(std::move(job));
+        }
+        if (birdsEyeTiers[tier] && !birdsEyeFrame.empty()) {
+            // 鸟瞰视图的尺寸由比例参数决定，档位缩放直接作用在其上
+            BroadcastJob job;
+            job.image = birdsEyeFrame;
+            job.quality = settings.quality;
+            job.fastMode = fastMode;
+            job.tier = tier;
+            job.scale = settings.scale;
+            job.birdsEye = true;
+            job.captureTime = snapshot->timestamp;
+            job.sequence = broadcastSequence_++;
+            pushEncodeJob(std::move(job));
+        }
     }
-    
-    // 验证编码结果的大小合理性
-    if (buf.size() < 100 || buf.size() > 1024 * 1024) {  // 100字节到1MB之间
-        std::cerr << "Warning: JPEG encoded size abnormal (" << buf.size() 
-                  << " bytes), skipping frame transmission" << std::endl;
-        return;
+}
+
+void VideoStreamer::activeQualityTiers(bool cameraTiers[], bool birdsEyeTiers[]) {
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    for (const auto& entry : clientStates_) {
+        if (entry.second.view == VideoView::BirdsEye) {
+            birdsEyeTiers[entry.second.tier] = true;
+        } else {
+            cameraTiers[entry.second.tier] = true;
+        }
     }
-    
-    // 性能监控：网络传输时间
-    auto networkStart = std::chrono::high_resolution_clock::now();
-    
-    // 每100帧发送一次分辨率信息
-    if (frame_count % 100 == 0) {
-        // 构建帧信息消息
-        std::string info_message = std::string("{\"type\":\"frame_info\",\"width\":")
-                              + std::to_string(processedFrame.cols) + ",\"height\":"
-                              + std::to_string(processedFrame.rows) + "}";
-        
-        // 广播帧信息
-        std::lock_guard<std::mutex> conn_lock(conn_mutex_);
-        for (auto conn : connections_) {
-            if (conn) {
-                try {
-                    conn->send_text(info_message);
-                } catch (const std::exception& e) {
-                    std::cerr << "Error sending frame info: " << e.what() << std::endl;
+}
+
+bool VideoStreamer::prepareTileUpdate(const cv::Mat& frame, BroadcastJob& job) {
+    const int tileSize = tileSize_;
+    bool keyframe = tileKeyframePending_.exchange(false) ||
+                    tileReference_.size() != frame.size() ||
+                    tileReference_.type() != frame.type() ||
+                    ++framesSinceKeyframe_ >= keyframeInterval_;
+    
+    std::vector<cv::Rect> changedTiles;
+    int totalTiles = 0;
+    if (!keyframe) {
+        // 逐块计算与上一次发送内容的绝对差之和（cv::norm L1 使用SIMD实现）
+        double thresholdPerPixel = tileChangeThreshold_ * frame.channels();
+        for (int y = 0; y < frame.rows; y += tileSize) {
+            for (int x = 0; x < frame.cols; x += tileSize) {
+                cv::Rect tile(x, y, std::min(tileSize, frame.cols - x), std::min(tileSize, frame.rows - y));
+                double sad = cv::norm(frame(tile), tileReference_(tile), cv::NORM_L1);
+                if (sad > thresholdPerPixel * tile.area()) {
+                    changedTiles.push_back(tile);
                 }
+                totalTiles++;
             }
         }
+        
+        if (changedTiles.empty()) {
+            return false;
+        }
+        
+        // 变化超过一半时整帧编码更省
+        if (changedTiles.size() * 2 > static_cast<size_t>(totalTiles)) {
+            keyframe = true;
+        }
     }
     
-    // 广播帧数据 - 添加异常处理
-    {
-        std::lock_guard<std::mutex> lock(conn_mutex_);
-        for (auto conn : connections_) {
-            if (conn) {
-                try {
-                    conn->send_binary(std::string(buf.begin(), buf.end()));
-                } catch (const std::exception& e) {
-                    std::cerr << "Error sending frame data: " << e.what() << std::endl;
-                }
-            }
+    if (keyframe) {
+        // 关键帧：以普通JPEG发送，同时作为新的参考帧
+        if (tileReference_.size() != frame.size() || tileReference_.type() != frame.type()) {
+            tileReference_ = FramePool::instance().acquire(frame.size(), frame.type());
+        }
+        frame.copyTo(tileReference_);
+        framesSinceKeyframe_ = 0;
+        job.tiles.clear();
+        job.tileUpdate = false;
+        keyframesSent_++;
+    } else {
+        // 参考帧只更新已发送的块，使其与客户端画面保持一致
+        for (const auto& tile : changedTiles) {
+            cv::Mat referenceTile = tileReference_(tile);
+            frame(tile).copyTo(referenceTile);
         }
+        tilesEncoded_ += changedTiles.size();
+        tilesTotal_ += totalTiles;
+        job.tiles = std::move(changedTiles);
+        job.tileUpdate = true;
     }
-    
+    return true;
+}
+
+EncodedFramePtr VideoStreamer::encodeTileUpdate(const BroadcastJob& job) {
+    auto encodeStart = std::chrono::high_resolution_clock::now();
+    std::vector<int> encode_params = {
+        cv::IMWRITE_JPEG_QUALITY, job.quality,
+        cv::IMWRITE_JPEG_OPTIMIZE, job.fastMode ? 0 : 1,
+        cv::IMWRITE_JPEG_PROGRESSIVE, 0
+    };
+    
+    // 消息格式（小端）：
+    //   "TILE" | version u8 | flags u8 | tileCount u16 | sequence u32 | frameWidth u16 | frameHeight u16
+    //   每个块：x u16 | y u16 | width u16 | height u16 | jpegLength u32 | JPEG数据
+    auto encoded = std::make_shared<EncodedFrame>();
+    std::string& payload = encoded->payload;
+    auto putU16 = [&payload](uint32_t v) { payload.push_back(static_cast<char>(v & 0xFF)); payload.push_back(static_cast<char>((v >> 8) & 0xFF)); };
+    auto putU32 = [&putU16](uint32_t v) { putU16(v & 0xFFFF); putU16(v >> 16); };
+    
+    payload.append("TILE", 4);
+    payload.push_back(1);  // version
+    payload.push_back(0);  // flags
+    putU16(static_cast<uint32_t>(job.tiles.size()));
+    putU32(static_cast<uint32_t>(job.sequence));
+    putU16(job.image.cols);
+    putU16(job.image.rows);
+    
+    thread_local std::vector<uchar> buf;
+    for (const auto& tile : job.tiles) {
+        buf.clear();
+        try {
+            if (!cv::imencode(".jpg", job.image(tile), buf, encode_params) || buf.empty()) {
+                std::cerr << "Warning: Tile JPEG encoding failed" << std::endl;
+                return nullptr;
+            }
+        } catch (const cv::Exception& e) {
+            std::cerr << "OpenCV error in tile encoding: " << e.what() << std::endl;
+            return nullptr;
+        }
+        putU16(tile.x);
+        putU16(tile.y);
+        putU16(tile.width);
+        putU16(tile.height);
+        putU32(static_cast<uint32_t>(buf.size()));
+        payload.append(reinterpret_cast<const char*>(buf.data()), buf.size());
+    }
+    
+    encoded->tileUpdate = true;
+    encoded->quality = job.quality;
+    encoded->width = job.image.cols;
+    encoded->height = job.image.rows;
+    encoded->sequence = job.sequence;
+    encoded->captureTime = job.captureTime;
+    encoded->encodeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - encodeStart).count();
+    broadcastBytesCopied_ += payload.size();
+    return encoded;
+}
+
+void VideoStreamer::setTiledStreaming(bool enabled, int tileSize) {
+    if (tileSize < 16 || tileSize > 512) {
+        std::cerr << "Invalid tile size: " << tileSize << " (valid range: 16-512)" << std::endl;
+        return;
+    }
+    tileSize_ = tileSize;
+    tileKeyframePending_ = true;
+    tiledStreaming_ = enabled;
+    std::cout << "🧩 [TILED STREAMING] Set to: " << (enabled ? "enabled" : "disabled")
+              << " (tile size " << tileSize << ")" << std::endl;
+}
+
+bool VideoStreamer::isTiledStreaming() const {
+    return tiledStreaming_;
+}
+
+void VideoStreamer::encodeThread() {
+    BroadcastJob job;
+    
+    while (running_) {
+        if (!encodeQueue_.popWait(job, std::chrono::milliseconds(100))) {
+            continue;
+        }
+        
+        // 性能监控：JPEG编码时间
+        auto encodeStart = std::chrono::high_resolution_clock::now();
+        
+        // 每个档位每帧只编码一次，编码结果在该档位的连接间共享
+        EncodedFramePtr encoded = job.tileUpdate ? encodeTileUpdate(job) : encodeBroadcastFrame(job);
+        job.image.release();
+        job.tiles.clear();
+        if (!encoded) {
+            abandonedSequences_.push(job.sequence);  // 发送线程不必等待这个序号
+            if (job.tileUpdate) {
+                tileKeyframePending_ = true;  // 客户端缺少这次更新，尽快发送关键帧
+            }
+        }
+        
+        auto encodeEnd = std::chrono::high_resolution_clock::now();
+        encodeTimer_.add(std::chrono::duration<double, std::milli>(encodeEnd - encodeStart).count());
+        
+        if (encoded) {
+            encodedFrames_++;
+            pushEncodedFrame(std::move(encoded));
+        }
+    }
+}
+
+void VideoStreamer::sendThread() {
+    EncodedFramePtr encoded;
+    auto lastDetailedReport = std::chrono::steady_clock::now();
+    
+    // 重排缓冲区：编码线程并行完成的帧可能乱序到达，按序号依次发送
+    std::map<uint64_t, PendingFrame> pending;
+    uint64_t nextSequence = 0;
+    bool haveNextSequence = false;
+    
+    while (running_) {
+        bool received = sendQueue_.popWait(encoded, std::chrono::milliseconds(10));
+        auto now = std::chrono::steady_clock::now();
+        
+        if (received) {
+            if (!haveNextSequence) {
+                nextSequence = encoded->sequence;
+                haveNextSequence = true;
+            }
+            
+            if (encoded->sequence < nextSequence) {
+                // 已经跳过了这个序号：按策略丢弃或直接发送
+                // 晚到的块更新会覆盖客户端上更新的内容，总是丢弃；只有完整帧可以按 Deliver 策略发送
+                lateFrames_++;
+                if (lateFramePolicy_ == LateFramePolicy::Deliver && !encoded->tileUpdate) {
+                    deliverEncodedFrame(encoded);
+                    if (tiledStreaming_) {
+                        tileKeyframePending_ = true;  // 客户端画面已回退到旧帧，与参考帧不一致
+                    }
+                } else {
+                    tileKeyframePending_ = true;  // 丢弃的可能是块更新，发送关键帧重新同步
+                }
+            } else {
+                pending[encoded->sequence] = PendingFrame{std::move(encoded), now};
+            }
+            encoded.reset();
+        }
+        
+        // 已确定不会到达的序号作为空位放入重排缓冲区，轮到它时直接跳过，不等待超时
+        uint64_t abandoned;
+        while (abandonedSequences_.tryPop(abandoned)) {
+            if (haveNextSequence && abandoned >= nextSequence) {
+                pending.emplace(abandoned, PendingFrame{nullptr, now});
+            }
+        }
+        
+        // 按序发送所有已就绪的帧
+        while (!pending.empty()) {
+            auto head = pending.begin();
+            if (head->first != nextSequence) {
+                // 缺失的序号可能仍在编码中，也可能在队列中被丢弃或编码失败
+                // 等待超时或积压超过编码线程数的两倍时跳过缺口
+                auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(now - head->second.arrival).count();
+                if (waited < reorderTimeoutMs_ && pending.size() <= static_cast<size_t>(2 * encoderThreadCount_)) {
+                    break;
+                }
+                skippedGaps_ += head->first - nextSequence;
+                nextSequence = head->first;
+                tileKeyframePending_ = true;  // 跳过的可能是块更新，发送关键帧重新同步
+            }
+            if (head->second.frame) {
+                deliverEncodedFrame(head->second.frame);
+            }
+            pending.erase(head);
+            nextSequence++;
+        }
+        
+        // 性能报告（每5秒输出一次详细分析）
+        auto reportNow = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::seconds>(reportNow - lastDetailedReport).count() >= 5) {
+            double reportSeconds = std::chrono::duration<double>(reportNow - lastDetailedReport).count();
+            uint64_t sentInPeriod = sendTimer_.count;
+            double avgFrameGet = frameGetTimer_.averageAndReset();
+            double avgProcessing = overlayTimer_.averageAndReset();
+            double avgEncode = encodeTimer_.averageAndReset();
+            double avgNetwork = sendTimer_.averageAndReset();
+            double avgLatency = latencyTimer_.averageAndReset();
+            
+            // 各阶段并行运行，吞吐量由最慢的阶段决定
+            // 编码阶段由多个线程并行执行，其吞吐量按线程数折算
+            double slowestStage = std::max({avgFrameGet + avgProcessing, avgEncode / encoderThreadCount_, avgNetwork});
+            
+            uint64_t copiedBytes = broadcastBytesCopied_.exchange(0);
+            broadcastBytesCopiedPerSecond_ = static_cast<uint64_t>(copiedBytes / reportSeconds);
+            
+            size_t connectionCount;
+            {
+                std::lock_guard<std::mutex> conn_lock(conn_mutex_);
+                connectionCount = connections_.size();
+            }
+            
+            std::cout << "📊 [BROADCAST PERFORMANCE] Average times (ms):" << std::endl;
+            std::cout << "  📥 Frame Get: " << std::fixed << std::setprecision(2) << avgFrameGet << "ms" << std::endl;
+            std::cout << "  🔧 Processing: " << avgProcessing << "ms" << std::endl;
+            std::cout << "  📷 JPEG Encode: " << avgEncode << "ms (" << encoderThreadCount_ << " threads)" << std::endl;
+            std::cout << "  🌐 Network Send: " << avgNetwork << "ms" << std::endl;
+            std::cout << "  ⏱️ Capture→Send Latency: " << avgLatency << "ms" << std::endl;
+            std::cout << "  🔄 Pipeline FPS bound: " << (slowestStage > 0 ? 1000.0 / slowestStage : 0.0) << std::endl;
+            std::cout << "  🎯 Actual FPS: " << (sentInPeriod / reportSeconds) << " (Target: " << fps_ << ")" << std::endl;
+            std::cout << "  📦 Avg JPEG Size: " << (lastPayloadSize_ / 1024) << "KB" << std::endl;
+            std::cout << "  📋 Bytes Copied: " << (broadcastBytesCopiedPerSecond_ / 1024) << "KB/s" << std::endl;
+            std::cout << "  🔗 Connections: " << connectionCount << std::endl;
+            if (adaptiveQualityEnabled_ && !tiledStreaming_) {
+                for (const auto& client : getClientQualityStats()) {
+                    std::cout << "  📶 Client tier " << client.tier << " (q" << client.quality << ", x" << client.scale
+                              << ", 1/" << client.frameSkip << "): ";
+                    if (client.acknowledging) {
+                        std::cout << "ack " << client.ackLatencyMs << "ms, in flight " << client.framesInFlight
+                                  << " / " << (client.outstandingBytes / 1024) << "KB" << std::endl;
+                    } else {
+                        std::cout << "no acks" << std::endl;
+                    }
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(captureBackendMutex_);
+                if (captureBackend_) {
+                    std::cout << "  📹 Capture buffers in use: " << captureBackend_->buffersInUse() << "/"
+                              << captureBackend_->bufferCount() << " (" << captureBackend_->name() << ")" << std::endl;
+                }
+            }
+            if (tiledStreaming_) {
+                uint64_t tiles = tilesTotal_.exchange(0);
+                uint64_t changed = tilesEncoded_.exchange(0);
+                std::cout << "  🧩 Tiled: " << changed << "/" << tiles << " tiles encoded ("
+                          << (tiles > 0 ? 100.0 * changed / tiles : 0.0) << "%), keyframes " << keyframesSent_.exchange(0) << std::endl;
+            }
+            if (arucoMode_) {
+                ArUcoDetectionStatus aruco = getArUcoDetectionStatus();
+                std::cout << "  🔖 ArUco: detect " << aruco.averageDetectMs << "ms, " << aruco.detections
+                          << " detections (" << aruco.replacedFrames << " frames skipped), result age "
+                          << aruco.resultAgeFrames << " frames / " << aruco.resultAgeMs << "ms" << std::endl;
+            }
+            std::cout << "  🎞️ MJPEG Passthrough: " << (mjpegPassthroughActive_ ? "ON" : "OFF")
+                      << " (frames " << passthroughFrames_ << ", lazy decodes " << passthroughDecodes_ << ")" << std::endl;
+            std::cout << "  🔀 Reorder: late " << lateFrames_ << " ("
+                      << (lateFramePolicy_ == LateFramePolicy::Drop ? "dropped" : "delivered")
+                      << "), skipped gaps " << skippedGaps_ << std::endl;
+            for (const auto& stage : getPipelineStats()) {
+                std::cout << "  🧵 Stage " << stage.name << ": queue " << stage.queueDepth << "/" << stage.queueCapacity
+                          << ", dropped " << stage.dropped << ", frames " << stage.processed << std::endl;
+            }
+            
+            lastDetailedReport = reportNow;
+        }
+    }
+}
+
+bool VideoStreamer::pushEncodeJob(BroadcastJob job) {
+    return encodeQueue_.push(std::move(job), [this](BroadcastJob& dropped) {
+        abandonedSequences_.push(dropped.sequence);
+    });
+}
+
+void VideoStreamer::pushEncodedFrame(EncodedFramePtr encoded) {
+    sendQueue_.push(std::move(encoded), [this](EncodedFramePtr& dropped) {
+        abandonedSequences_.push(dropped->sequence);
+        if (dropped->tileUpdate) {
+            tileKeyframePending_ = true;  // 客户端缺少这次更新，尽快发送关键帧
+        }
+    });
+}
+
+void VideoStreamer::deliverEncodedFrame(const EncodedFramePtr& encoded) {
+    // 性能监控：网络传输时间
+    auto networkStart = std::chrono::high_resolution_clock::now();
+    
+    // 广播帧数据 - 同一档位的连接共享同一份只读编码结果
+    sendEncodedFrame(encoded);
+    lastPayloadSize_ = encoded->payload.size();
+    sentFrames_++;
+    
     auto networkEnd = std::chrono::high_resolution_clock::now();
-    double networkTime = std::chrono::duration<double, std::milli>(networkEnd - networkStart).count();
-    
-    // 总体广播时间
-    auto broadcastEnd = std::chrono::high_resolution_clock::now();
-    double totalBroadcastTime = std::chrono::duration<double, std::milli>(broadcastEnd - broadcastStart).count();
-    
-    frame_count++;
-    
-    // 性能报告（每5秒输出一次详细分析）
-    static auto lastDetailedReport = std::chrono::steady_clock::now();
-    static double totalFrameGetTime = 0, totalProcessingTime = 0, totalEncodeTime = 0, totalNetworkTime = 0, cumulativeBroadcastTime = 0;
-    static int reportFrameCount = 0;
-    
-    totalFrameGetTime += frameGetTime;
-    totalProcessingTime += processingTime;
-    totalEncodeTime += encodeTime;
-    totalNetworkTime += networkTime;
-    cumulativeBroadcastTime += totalBroadcastTime;
-    reportFrameCount++;
-    
-    auto reportNow = std::chrono::steady_clock::now();
-    if (std::chrono::duration_cast<std::chrono::seconds>(reportNow - lastDetailedReport).count() >= 5) {
-        double avgFrameGet = totalFrameGetTime / reportFrameCount;
-        double avgProcessing = totalProcessingTime / reportFrameCount;
-        double avgEncode = totalEncodeTime / reportFrameCount;
-        double avgNetwork = totalNetworkTime / reportFrameCount;
-        double avgTotal = cumulativeBroadcastTime / reportFrameCount;
-        
-        std::cout << "📊 [BROADCAST PERFORMANCE] Average times (ms):" << std::endl;
-        std::cout << "  📥 Frame Get: " << std::fixed << std::setprecision(2) << avgFrameGet << "ms" << std::endl;
-        std::cout << "  🔧 Processing: " << avgProcessing << "ms" << std::endl;
-        std::cout << "  📷 JPEG Encode: " << avgEncode << "ms" << std::endl;
-        std::cout << "  🌐 Network Send: " << avgNetwork << "ms" << std::endl;
-        std::cout << "  📡 Total Broadcast: " << avgTotal << "ms" << std::endl;
-        std::cout << "  🔄 Theoretical FPS: " << (1000.0 / avgTotal) << std::endl;
-        std::cout << "  📦 Avg JPEG Size: " << (buf.size() / 1024) << "KB" << std::endl;
-        std::cout << "  🔗 Connections: " << connections_.size() << std::endl;
-        
-        // 重置计数器
-        totalFrameGetTime = totalProcessingTime = totalEncodeTime = totalNetworkTime = cumulativeBroadcastTime = 0;
-        reportFrameCount = 0;
-        lastDetailedReport = reportNow;
-    }
-}
-
-bool VideoStreamer::getFrame(cv::Mat& frame) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (frame_.empty()) {
-        return false;
+    double sendMs = std::chrono::duration<double, std::milli>(networkEnd - networkStart).count();
+    sendTimer_.add(sendMs);
+    latencyTimer_.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - encoded->captureTime).count());
+    
+    if (deliveryObserver_) {
+        deliveryObserver_(*encoded, sendMs);
+    }
+}
+
+void VideoStreamer::setEncoderThreadCount(int count) {
+    if (count < 1 || count > 16) {
+        std::cerr << "Invalid encoder thread count: " << count << " (valid range: 1-16)" << std::endl;
+        return;
+    }
+    if (running_) {
+        std::cout << "⚠️ Encoder thread count will take effect after restart" << std::endl;
     }
+    encoderThreadCount_ = count;
+}
+
+int VideoStreamer::getEncoderThreadCount() const {
+    return encoderThreadCount_;
+}
+
+void VideoStreamer::setLateFramePolicy(LateFramePolicy policy) {
+    lateFramePolicy_ = policy;
+}
+
+VideoStreamer::LateFramePolicy VideoStreamer::getLateFramePolicy() const {
+    return lateFramePolicy_;
+}
+
+void VideoStreamer::setReorderTimeout(int milliseconds) {
+    reorderTimeoutMs_ = std::max(1, milliseconds);
+}
+
+std::vector<VideoStreamer::PipelineStageStats> VideoStreamer::getPipelineStats() const {
+    std::vector<PipelineStageStats> stats(4);
     
-    frame = frame_.clone();
-    return true;
+    // 采集阶段没有输入队列，丢帧发生在驱动缓冲区
+    stats[0].name = "capture";
+    stats[0].processed = capturedFrames_;
+    
+    stats[1].name = "process";
+    stats[1].queueDepth = captureQueue_.size();
+    stats[1].queueCapacity = captureQueue_.capacity();
+    stats[1].dropped = captureQueue_.droppedCount();
+    stats[1].processed = processedFrames_;
+    
+    stats[2].name = "encode";
+    stats[2].queueDepth = encodeQueue_.size();
+    stats[2].queueCapacity = encodeQueue_.capacity();
+    stats[2].dropped = encodeQueue_.droppedCount();
+    stats[2].processed = encodedFrames_;
+    
+    stats[3].name = "send";
+    stats[3].queueDepth = sendQueue_.size();
+    stats[3].queueCapacity = sendQueue_.capacity();
+    stats[3].dropped = sendQueue_.droppedCount();
+    stats[3].processed = sentFrames_;
+    
+    return stats;
+}
+
+EncodedFramePtr VideoStreamer::encodeBroadcastFrame(const BroadcastJob& job) {
+    auto encodeStart = std::chrono::high_resolution_clock::now();
+    std::vector<int> encode_params = {
+        cv::IMWRITE_JPEG_QUALITY, job.quality,
+        cv::IMWRITE_JPEG_OPTIMIZE, job.fastMode ? 0 : 1,  // 快速模式禁用优化
+        cv::IMWRITE_JPEG_PROGRESSIVE, 0  // 禁用渐进式JPEG以加快编码
+    };
+    
+    // 将帧编码为JPEG，使用优化的参数减少编码时间
+    // 每个编码线程复用自己的JPEG缓冲区，容量在热身后保持不变
+    thread_local std::vector<uchar> buf;
+    buf.clear();
+    cv::Mat frame = job.image;
+    bool encode_success = false;
+    try {
+        // 低档位先缩小再编码，缩放结果使用池化缓冲区
+        if (job.scale < 1.0) {
+            cv::Size scaledSize(std::max(1, static_cast<int>(job.image.cols * job.scale)),
+                                std::max(1, static_cast<int>(job.image.rows * job.scale)));
+            frame = FramePool::instance().acquire(scaledSize, job.image.type());
+            cv::resize(job.image, frame, scaledSize, 0, 0, cv::INTER_AREA);
+        }
+        encode_success = cv::imencode(".jpg", frame, buf, encode_params);
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error in JPEG encoding: " << e.what() << std::endl;
+        return nullptr;
+    } catch (const std::exception& e) {
+        std::cerr << "Error in JPEG encoding: " << e.what() << std::endl;
+        return nullptr;
+    }
+    
+    // 检查编码是否成功
+    if (!encode_success || buf.empty()) {
+        std::cerr << "Warning: JPEG encoding failed, skipping frame transmission" << std::endl;
+        return nullptr;
+    }
+    
+    // 验证编码结果的大小合理性
+    if (buf.size() < 100 || buf.size() > 1024 * 1024) {  // 100字节到1MB之间
+        std::cerr << "Warning: JPEG encoded size abnormal (" << buf.size() 
+                  << " bytes), skipping frame transmission" << std::endl;
+        return nullptr;
+    }
+    
+    // 每帧只生成一次消息体，之后所有连接共享
+    auto encoded = std::make_shared<EncodedFrame>();
+    encoded->payload.assign(buf.begin(), buf.end());
+    encoded->quality = job.quality;
+    encoded->width = frame.cols;
+    encoded->height = frame.rows;
+    encoded->sequence = job.sequence;
+    encoded->tier = job.tier;
+    encoded->birdsEye = job.birdsEye;
+    encoded->captureTime = job.captureTime;
+    encoded->encodeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - encodeStart).count();
+    broadcastBytesCopied_ += encoded->payload.size();
+    
+    return encoded;
+}
+
+void VideoStreamer::sendEncodedFrame(const EncodedFramePtr& encoded) {
+    if (!encoded) return;
+    
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    for (auto& entry : clientStates_) {
+        Connection conn = entry.first;
+        ClientState& state = entry.second;
+        if (!conn || (encoded->tier >= 0 && encoded->tier != state.tier) ||
+            encoded->birdsEye != (state.view == VideoView::BirdsEye)) {
+            continue;
+        }
+        
+        try {
+            // 分辨率变化（切换档位）时立即发送帧信息，否则每隔一段时间重发一次
+            if (encoded->width != state.infoWidth || encoded->height != state.infoHeight ||
+                ++state.framesSinceInfo >= kFrameInfoInterval) {
+                conn->send_text(std::string("{\"type\":\"frame_info\",\"width\":")
+                                + std::to_string(encoded->width) + ",\"height\":"
+                                + std::to_string(encoded->height) + ",\"view\":\""
+                                + (encoded->birdsEye ? "birds_eye" : "camera") + "\"}");
+                state.infoWidth = encoded->width;
+                state.infoHeight = encoded->height;
+                state.framesSinceInfo = 0;
+            }
+            
+            // Crow 的 send_binary 按值接收消息体，每个连接仍会复制一次到其写队列
+            conn->send_binary(encoded->payload);
+            broadcastBytesCopied_ += encoded->payload.size();
+        } catch (const std::exception& e) {
+            std::cerr << "Error sending frame data: " << e.what() << std::endl;
+            continue;
+        }
+        
+        // 记录未确认的帧；不发确认的旧客户端只保留最近的记录
+        state.inFlight.emplace_back(encoded->payload.size(), now);
+        state.outstandingBytes += encoded->payload.size();
+        if (state.inFlight.size() > kMaxTrackedFrames) {
+            state.outstandingBytes -= state.inFlight.front().first;
+            state.inFlight.pop_front();
+        }
+        updateClientTier(state, now);
+    }
+}
+
+void VideoStreamer::acknowledgeFrame(Connection conn) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    auto it = clientStates_.find(conn);
+    if (it == clientStates_.end() || it->second.inFlight.empty()) {
+        return;
+    }
+    
+    // WebSocket 按序送达，确认按先进先出对应最早的未确认帧
+    ClientState& state = it->second;
+    auto sent = state.inFlight.front();
+    state.inFlight.pop_front();
+    state.outstandingBytes -= sent.first;
+    
+    double latencyMs = std::chrono::duration<double, std::milli>(now - sent.second).count();
+    state.ackLatencyMs = state.acknowledging ? state.ackLatencyMs * 0.8 + latencyMs * 0.2 : latencyMs;
+    state.acknowledging = true;
+    updateClientTier(state, now);
+}
+
+void VideoStreamer::updateClientTier(ClientState& state, std::chrono::steady_clock::time_point now) {
+    if (!state.acknowledging || !adaptiveQualityEnabled_) {
+        return;
+    }
+    
+    bool congested = state.ackLatencyMs > kDegradeLatencyMs ||
+                     state.inFlight.size() > kDegradeFramesInFlight ||
+                     state.outstandingBytes > kDegradeOutstandingBytes;
+    bool healthy = state.ackLatencyMs < kUpgradeLatencyMs && state.inFlight.size() <= kUpgradeFramesInFlight;
+    
+    if (!healthy) {
+        state.healthySince = std::chrono::steady_clock::time_point();
+    } else if (state.healthySince == std::chrono::steady_clock::time_point()) {
+        state.healthySince = now;
+    }
+    
+    int newTier = state.tier;
+    if (congested && state.tier < kQualityTierCount - 1 && now - state.lastTierChange >= kDegradeHold) {
+        newTier = state.tier + 1;
+    } else if (healthy && state.tier > 0 && now - state.healthySince >= kUpgradeHold &&
+               now - state.lastTierChange >= kUpgradeHold) {
+        newTier = state.tier - 1;
+    }
+    if (newTier == state.tier) {
+        return;
+    }
+    
+    if (state.tier == 0) {
+        degradedClients_++;
+    } else if (newTier == 0) {
+        degradedClients_--;
+    }
+    std::cout << "📶 Client quality tier " << state.tier << " -> " << newTier
+              << " (ack latency " << static_cast<int>(state.ackLatencyMs) << "ms, in flight "
+              << state.inFlight.size() << " frames / " << (state.outstandingBytes / 1024) << "KB)" << std::endl;
+    state.tier = newTier;
+    state.lastTierChange = now;
+}
+
+void VideoStreamer::setAdaptiveQualityEnabled(bool enabled) {
+    adaptiveQualityEnabled_ = enabled;
+    if (!enabled) {
+        // 所有连接回到最高档位
+        std::lock_guard<std::mutex> lock(conn_mutex_);
+        for (auto& entry : clientStates_) {
+            entry.second.tier = 0;
+        }
+        degradedClients_ = 0;
+    }
+    std::cout << "📶 Adaptive quality " << (enabled ? "enabled" : "disabled") << std::endl;
+}
+
+bool VideoStreamer::isAdaptiveQualityEnabled() const {
+    return adaptiveQualityEnabled_;
+}
+
+std::vector<VideoStreamer::ClientQualityStats> VideoStreamer::getClientQualityStats() {
+    std::vector<ClientQualityStats> stats;
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    for (const auto& entry : clientStates_) {
+        const ClientState& state = entry.second;
+        const QualityTier& settings = kQualityTiers[state.tier];
+        ClientQualityStats client;
+        client.tier = state.tier;
+        client.quality = settings.quality;
+        client.scale = settings.scale;
+        client.frameSkip = settings.frameSkip;
+        client.framesInFlight = state.inFlight.size();
+        client.outstandingBytes = state.outstandingBytes;
+        client.ackLatencyMs = state.ackLatencyMs;
+        client.acknowledging = state.acknowledging;
+        stats.push_back(client);
+    }
+    return stats;
+}
+
+void VideoStreamer::setClientVideoView(Connection conn, VideoView view) {
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    auto it = clientStates_.find(conn);
+    if (it == clientStates_.end() || it->second.view == view) {
+        return;
+    }
+    it->second.view = view;
+    it->second.infoWidth = 0;  // 下一帧重新发送 frame_info
+    if (view == VideoView::BirdsEye) {
+        birdsEyeClients_++;
+    } else {
+        birdsEyeClients_--;
+        tileKeyframePending_ = true;  // 回到原始画面的客户端需要完整画面才能合成分块更新
+    }
+    std::cout << "🗺️ [BIRDS EYE] Client view set to " << (view == VideoView::BirdsEye ? "birds-eye" : "camera")
+              << ", birds-eye clients: " << birdsEyeClients_ << std::endl;
+}
+
+VideoStreamer::VideoView VideoStreamer::getClientVideoView(Connection conn) {
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    auto it = clientStates_.find(conn);
+    return it != clientStates_.end() ? it->second.view : VideoView::Camera;
+}
+
+void VideoStreamer::setBirdsEyeConfig(const cv::Rect2f& groundBounds, double mmPerPixel) {
+    std::lock_guard<std::mutex> lock(birdsEyeMutex_);
+    birdsEyeRequested_.groundBounds = groundBounds;
+    birdsEyeRequested_.mmPerPixel = mmPerPixel;
+    birdsEyeActive_ = birdsEyeRequested_;  // 处理线程生成下一帧鸟瞰视图时补全自动参数
+}
+
+BirdsEyeView::Config VideoStreamer::getBirdsEyeConfig() const {
+    std::lock_guard<std::mutex> lock(birdsEyeMutex_);
+    return birdsEyeActive_;
+}
+
+cv::Size VideoStreamer::getBirdsEyeOutputSize() const {
+    return cv::Size(birdsEyeWidth_, birdsEyeHeight_);
+}
+
+uint64_t VideoStreamer::getBroadcastBytesCopiedPerSecond() const {
+    return broadcastBytesCopiedPerSecond_;
+}
+
+FramePtr VideoStreamer::getFrame() const {
+    return currentFrame();
+}
+
+FramePtr VideoStreamer::currentFrame() const {
+    FramePtr snapshot = latestFrame_.load();
+    if (!snapshot || !snapshot->image.empty() || !snapshot->compressed) {
+        return snapshot;
+    }
+    
+    // MJPEG直通帧：第一个需要像素的消费者负责解码，并把结果回填到槽位供其他消费者复用
+    try {
+        const std::string& payload = snapshot->compressed->payload;
+        cv::Mat jpegData(1, static_cast<int>(payload.size()), CV_8UC1, const_cast<char*>(payload.data()));
+        cv::Mat decodedImage = FramePool::instance().acquire(cv::Size(snapshot->compressed->width, snapshot->compressed->height), CV_8UC3);
+        cv::imdecode(jpegData, cv::IMREAD_COLOR, &decodedImage);
+        if (decodedImage.empty()) {
+            std::cerr << "Warning: Failed to decode passthrough MJPEG frame" << std::endl;
+            return nullptr;
+        }
+        
+        auto decoded = std::make_shared<Frame>(*snapshot);
+        decoded->image = decodedImage;
+        passthroughDecodes_++;
+        FramePtr result = decoded;
+        latestFrame_.replace(snapshot, result);  // 槽位已有更新的帧时放弃回填
+        return result;
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error decoding passthrough frame: " << e.what() << std::endl;
+        return nullptr;
+    }
 }
 
 void VideoStreamer::captureThread() {
     cv::Mat frame;
-    
-    // 性能监控变量
-    auto lastPerformanceReport = std::chrono::steady_clock::now();
-    int frameProcessedCount = 0;
-    double totalProcessingTime = 0.0;
+    uint64_t captureSequence = 0;
+    bool rawMode = false;  // 当前是否让摄像头输出未解码的MJPEG数据
     
     while (running_) {
-        auto frameStart = std::chrono::high_resolution_clock::now();
+        // MJPEG直通：没有任何功能需要像素时关闭解码，由采集线程切换（cap_只在本线程访问）
+        bool wantRaw = mjpegPassthroughEnabled_ && mjpegPassthroughSupported_ && !needsDecodedFrames();
+        if (captureBackend_) {
+            // 独立采集后端总是输出原始数据，是否直通由处理阶段决定
+            rawMode = captureBackend_->pixelFormat() == CapturePixelFormat::MJPEG;
+            mjpegPassthroughActive_ = rawMode && mjpegPassthroughEnabled_ && !needsDecodedFrames();
+        } else if (wantRaw != rawMode) {
+            if (cap_.set(cv::CAP_PROP_CONVERT_RGB, wantRaw ? 0 : 1) || !wantRaw) {
+                rawMode = wantRaw;
+                std::cout << "🎞️ [MJPEG PASSTHROUGH] " << (rawMode ? "Enabled" : "Disabled") << std::endl;
+            } else {
+                std::cerr << "Warning: Camera backend does not support raw MJPEG output, passthrough disabled" << std::endl;
+                mjpegPassthroughSupported_ = false;
+            }
+        }
+        if (!captureBackend_) {
+            mjpegPassthroughActive_ = rawMode;
+        }
+        
+        // 上一帧已交给处理阶段，让下一次读取从帧缓冲池分配
+        FramePool::instance().attach(frame);
         
-        if (cap_.read(frame)) {
+        // 独立后端返回驱动缓冲区的零拷贝视图，视图释放后缓冲区自动归还驱动
+        bool readSuccess = captureBackend_ ? captureBackend_->read(frame) : cap_.read(frame);
+        if (readSuccess) {
             // 成功读取帧，重置失败计数器
             if (frameReadFailureCount_ > 0) {
                 std::cout << "📹 [CAMERA RECOVERY] 摄像头恢复正常，重置失败计数器" << std::endl;
@@ -1129,167 +2029,33 @@ void VideoStreamer::captureThread() {
                 continue;
             }
             
-            // 创建处理帧的副本，避免修改原始帧
-            cv::Mat processedFrame = frame.clone();
-            
-            // 性能优化：只在相机校正启用且已标定时才进行畸变校正
-            // 并且不在标定模式下进行校正（标定需要原始畸变图像）
-            if (isCameraCalibrated() && cameraCorrectionEnabled_ && !cameraCalibrationMode_) {
-                try {
-                    auto undistortStart = std::chrono::high_resolution_clock::now();
-                    
-                    cv::Mat undistortedFrame = cameraCalibrator_.undistortImage(processedFrame);
-                    
-                    auto undistortEnd = std::chrono::high_resolution_clock::now();
-                    double undistortTime = std::chrono::duration<double, std::milli>(undistortEnd - undistortStart).count();
-                    
-                    // 验证去畸变结果是否有效
-                    if (!undistortedFrame.empty() && 
-                        undistortedFrame.cols == processedFrame.cols && 
-                        undistortedFrame.rows == processedFrame.rows) {
-                        processedFrame = undistortedFrame;
-                        
-                        // 性能日志（每10秒输出一次）
-                        static auto lastUndistortLog = std::chrono::steady_clock::now();
-                        auto undistortLogTime = std::chrono::steady_clock::now();
-                        if (std::chrono::duration_cast<std::chrono::seconds>(undistortLogTime - lastUndistortLog).count() >= 10) {
-                            std::cout << "📊 [PERFORMANCE] Undistortion time: " << undistortTime << "ms" << std::endl;
-                            lastUndistortLog = undistortLogTime;
-                        }
-                    } else {
-                        cerr << "Warning: Undistortion returned invalid result, using original frame" << endl;
-                    }
-                } catch (const cv::Exception& e) {
-                    cerr << "OpenCV error in undistortion: " << e.what() << endl;
-                    // 继续使用原始帧，不进行去畸变
-                } catch (const std::exception& e) {
-                    cerr << "Error in undistortion: " << e.what() << endl;
-                    // 继续使用原始帧，不进行去畸变
-                }
-            }
-            
-            // 如果处于相机标定模式，使用轻量级显示处理
-            if (cameraCalibrationMode_) {
-                try {
-                    // 性能优化：降低标定模式下的检测频率
-                    static int detectionCounter = 0;
-                    detectionCounter++;
-                    
-                    // 每3帧才进行一次角点检测，减少CPU负载
-                    if (detectionCounter % 3 == 0) {
-                        // 对显示分辨率的帧进行轻量级处理
-                        cv::Mat displayFrame;
-                        if (processedFrame.cols != displayWidth_ || processedFrame.rows != displayHeight_) {
-                            cv::resize(processedFrame, displayFrame, cv::Size(displayWidth_, displayHeight_));
-                        } else {
-                            displayFrame = processedFrame.clone();
-                        }
-                        
-                        // 只在显示帧上做简单的棋盘格检测和绘制（低精度，快速）
-                        std::vector<cv::Point2f> corners;
-                        bool found = false;
-                        
-                        // 使用更宽松的检测条件进行快速检测
-                        int quickFlags = cv::CALIB_CB_ADAPTIVE_THRESH;
-                        found = cv::findChessboardCorners(displayFrame, cameraCalibrator_.getBoardSize(), corners, quickFlags);
-                        
-                        if (found) {
-                            // 缩放角点坐标回原始帧比例（用于精确显示）
-                            float scaleX = (float)processedFrame.cols / displayWidth_;
-                            float scaleY = (float)processedFrame.rows / displayHeight_;
-                            for (auto& corner : corners) {
-                                corner.x *= scaleX;
-                                corner.y *= scaleY;
-                            }
-                            
-                            cv::drawChessboardCorners(processedFrame, cameraCalibrator_.getBoardSize(), corners, found);
-                            cv::putText(processedFrame, "Chessboard OK", cv::Point(processedFrame.cols - 160, 30),
-                                      cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(226, 43, 138), 2, cv::LINE_AA); // 紫色 (138, 43, 226) 表示成功
-                        } else {
-                            cv::putText(processedFrame, "Searching...", cv::Point(processedFrame.cols - 150, 30),
-                                      cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 100, 255), 2, cv::LINE_AA);
-                        }
-                    }
-                    
-                    // 显示当前校正状态
-                    if (cameraCorrectionEnabled_ && isCameraCalibrated()) {
-                        cv::putText(processedFrame, "Correction: OFF (Calibration Mode)", cv::Point(10, processedFrame.rows - 20),
-                                  cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 165, 0), 1, cv::LINE_AA);
-                    }
-                    
-                } catch (const std::exception& e) {
-                    cerr << "Error in chessboard visualization: " << e.what() << endl;
-                }
-            } else if (calibrationMode_) {
-                // 坐标变换标定模式的简洁提示
-                                    cv::putText(processedFrame, "Click to add point", cv::Point(processedFrame.cols - 180, 30),
-                          cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 149, 255), 2, cv::LINE_AA); // 橙色 (255, 149, 0) 表示提示
-            } else {
-                // 正常模式：显示校正状态
-                if (isCameraCalibrated() && cameraCorrectionEnabled_) {
-                    cv::putText(processedFrame, "Correction: ON", cv::Point(10, processedFrame.rows - 20),
-                              cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(226, 43, 138), 1, cv::LINE_AA); // 紫色 (138, 43, 226) 表示成功
-                } else if (isCameraCalibrated()) {
-                    cv::putText(processedFrame, "Correction: OFF", cv::Point(10, processedFrame.rows - 20),
-                              cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(112, 25, 25), 1, cv::LINE_AA); // 深蓝色 (25, 25, 112) 表示错误
-                }
-            }
-            
-            // 双流策略：强化安全的Mat操作
-            {
-                std::lock_guard<std::mutex> lock(mutex_);
-                
-                // 验证processedFrame的有效性
-                if (processedFrame.empty() || processedFrame.cols <= 0 || processedFrame.rows <= 0) {
-                    std::cerr << "Warning: Invalid processedFrame, skipping frame update" << std::endl;
+            // 直通模式下应得到一行原始JPEG数据；后端忽略该设置或格式不是MJPEG时退回解码模式
+            CapturePixelFormat format = captureBackend_ ? captureBackend_->pixelFormat() : CapturePixelFormat::BGR;
+            if (rawMode) {
+                bool isJpeg = frame.type() == CV_8UC1 && frame.rows == 1 && frame.cols >= 4 &&
+                              frame.data[0] == 0xFF && frame.data[1] == 0xD8;
+                if (isJpeg) {
+                    format = CapturePixelFormat::MJPEG;
+                } else if (captureBackend_) {
+                    cerr << "Error: Corrupted MJPEG frame from " << captureBackend_->name() << endl;
                     continue;
-                }
-                
-                try {
-                    // 安全的复制策略：确保Mat对象完整性
-                    frame_ = processedFrame.clone();           // 深度复制，避免move后的空对象
-                    detectionFrame_ = processedFrame.clone();  // 独立复制，确保两个对象都有效
-                    
-                    // 验证复制结果
-                    if (frame_.empty() || detectionFrame_.empty()) {
-                        std::cerr << "Error: Frame copy operation failed" << std::endl;
-                        continue;
+                } else {
+                    std::cerr << "Warning: Camera did not deliver raw MJPEG data, passthrough disabled" << std::endl;
+                    mjpegPassthroughSupported_ = false;
+                    if (frame.type() == CV_8UC1 && frame.rows == 1) {
+                        continue;  // 未知的原始格式，丢弃该帧，下一轮恢复解码
                     }
-                    
-                } catch (const cv::Exception& e) {
-                    std::cerr << "OpenCV error in frame copying: " << e.what() << std::endl;
-                    continue;
-                } catch (const std::exception& e) {
-                    std::cerr << "Error in frame copying: " << e.what() << std::endl;
-                    continue;
                 }
             }
             
-            // 性能监控
-            auto frameEnd = std::chrono::high_resolution_clock::now();
-            double frameTime = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
-            totalProcessingTime += frameTime;
-            frameProcessedCount++;
-            
-            // 每10秒输出一次性能报告
-            auto frameReportTime = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::seconds>(frameReportTime - lastPerformanceReport).count() >= 10) {
-                double avgProcessingTime = totalProcessingTime / frameProcessedCount;
-                double theoreticalFPS = 1000.0 / avgProcessingTime;
-                
-                std::cout << "📊 [PERFORMANCE] Avg frame processing: " << avgProcessingTime << "ms, "
-                          << "Theoretical FPS: " << theoreticalFPS << ", "
-                          << "Correction: " << (cameraCorrectionEnabled_ ? "ON" : "OFF") << ", "
-                          << "Calibration mode: " << (cameraCalibrationMode_ ? "ON" : "OFF") << std::endl;
-                
-                // 添加系统资源信息
-                std::cout << "🖥️ [SYSTEM RESOURCES]\n" << getSystemResourceInfo() << std::endl;
-                
-                // 重置计数器
-                totalProcessingTime = 0.0;
-                frameProcessedCount = 0;
-                lastPerformanceReport = frameReportTime;
-            }
+            // 采集阶段只负责读帧：把帧交给处理阶段，下次read会分配新的缓冲区
+            CapturedFrame captured;
+            captured.format = format;
+            captured.image = std::move(frame);
+            captured.sequence = captureSequence++;
+            captured.captureTime = std::chrono::steady_clock::now();
+            captureQueue_.push(std::move(captured));
+            capturedFrames_++;
             
         } else {
             // 帧读取失败处理
@@ -1317,6 +2083,466 @@ void VideoStreamer::captureThread() {
     }
 }
 
+
+void VideoStreamer::processThread() {
+    CapturedFrame captured;
+    
+    // 性能监控变量
+    auto lastPerformanceReport = std::chrono::steady_clock::now();
+    int frameProcessedCount = 0;
+    double totalProcessingTime = 0.0;
+    uint64_t lastPoolAllocations = FramePool::instance().getStats().allocations;
+    
+    while (running_) {
+        if (!captureQueue_.popWait(captured, std::chrono::milliseconds(100))) {
+            continue;
+        }
+        
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        
+        if (captured.format == CapturePixelFormat::MJPEG && mjpegPassthroughEnabled_ && !needsDecodedFrames()) {
+            // MJPEG直通：摄像头输出的JPEG直接广播，跳过解码和重新编码
+            if (!processPassthroughFrame(captured)) {
+                continue;
+            }
+            captured.image.release();
+            processedFrames_++;
+        } else {
+            if (!convertCapturedFrame(captured) || !processCapturedFrame(captured)) {
+                continue;
+            }
+            captured.image.release();
+            processedFrames_++;
+            
+            // 准备广播帧并交给编码阶段
+            broadcastFrame();
+        }
+        
+        // 性能监控
+        auto frameEnd = std::chrono::high_resolution_clock::now();
+        double frameTime = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+        totalProcessingTime += frameTime;
+        frameProcessedCount++;
+        
+        // 每10秒输出一次性能报告
+        auto frameReportTime = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::seconds>(frameReportTime - lastPerformanceReport).count() >= 10) {
+            double avgProcessingTime = totalProcessingTime / frameProcessedCount;
+            double theoreticalFPS = 1000.0 / avgProcessingTime;
+            
+            std::cout << "📊 [PERFORMANCE] Avg frame processing: " << avgProcessingTime << "ms, "
+                      << "Theoretical FPS: " << theoreticalFPS << ", "
+                      << "Correction: " << (isFrameCorrectionActive() ? "FRAME" : isPointCorrectionActive() ? "POINTS" : "OFF") << ", "
+                      << "Calibration mode: " << (cameraCalibrationMode_ ? "ON" : "OFF") << std::endl;
+            
+            // 帧缓冲池：热身后每帧新分配次数应为0
+            FramePool::Stats poolStats = FramePool::instance().getStats();
+            double allocationsPerFrame = (double)(poolStats.allocations - lastPoolAllocations) / frameProcessedCount;
+            lastPoolAllocations = poolStats.allocations;
+            std::cout << "♻️ [FRAME POOL] Allocations/frame: " << allocationsPerFrame
+                      << ", total allocations: " << poolStats.allocations
+                      << ", reuses: " << poolStats.reuses
+                      << ", pooled: " << poolStats.pooledBuffers << " buffers ("
+                      << (poolStats.pooledBytes / (1024 * 1024)) << "MB)" << std::endl;
+            
+            // 添加系统资源信息
+            std::cout << "🖥️ [SYSTEM RESOURCES]\n" << getSystemResourceInfo() << std::endl;
+            
+            // 重置计数器
+            totalProcessingTime = 0.0;
+            frameProcessedCount = 0;
+            lastPerformanceReport = frameReportTime;
+        }
+    }
+}
+
+bool VideoStreamer::convertCapturedFrame(CapturedFrame& captured) {
+    if (captured.format == CapturePixelFormat::BGR) {
+        return true;
+    }
+    
+    // 原始数据解码/转换到帧缓冲池中的BGR图像，之后立即释放驱动缓冲区
+    try {
+        cv::Mat bgr;
+        if (captured.format == CapturePixelFormat::MJPEG) {
+            int jpegWidth = 0, jpegHeight = 0;
+            if (readJpegSize(captured.image.data, captured.image.total(), jpegWidth, jpegHeight)) {
+                bgr = FramePool::instance().acquire(cv::Size(jpegWidth, jpegHeight), CV_8UC3);
+            }
+            cv::imdecode(captured.image, cv::IMREAD_COLOR, &bgr);
+        } else {
+            bgr = FramePool::instance().acquire(captured.image.size(), CV_8UC3);
+            cv::cvtColor(captured.image, bgr, cv::COLOR_YUV2BGR_YUYV);
+        }
+        
+        if (bgr.empty()) {
+            std::cerr << "Warning: Failed to convert captured frame to BGR" << std::endl;
+            return false;
+        }
+        captured.image = bgr;
+        captured.format = CapturePixelFormat::BGR;
+        return true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error converting captured frame: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool VideoStreamer::processPassthroughFrame(CapturedFrame& captured) {
+    int jpegWidth = 0, jpegHeight = 0;
+    if (!readJpegSize(captured.image.data, captured.image.total(), jpegWidth, jpegHeight)) {
+        std::cerr << "Warning: Invalid MJPEG frame from camera, skipping" << std::endl;
+        return false;
+    }
+    
+    // 先决定本帧是否广播，以便按广播序号生成编码帧
+    size_t connectionCount = 0;
+    bool broadcast = acquireBroadcastSlot(connectionCount);
+    
+    auto encoded = std::make_shared<EncodedFrame>();
+    encoded->payload.assign(reinterpret_cast<const char*>(captured.image.data), captured.image.total());
+    encoded->quality = 0;  // 摄像头原生质量
+    encoded->width = jpegWidth;
+    encoded->height = jpegHeight;
+    encoded->sequence = broadcast ? broadcastSequence_++ : 0;
+    encoded->captureTime = captured.captureTime;
+    EncodedFramePtr shared = encoded;
+    
+    // 发布为最新帧：像素数据在有消费者需要时才解码（见 currentFrame）
+    auto published = std::make_shared<Frame>();
+    published->compressed = shared;
+    published->sequence = captured.sequence;
+    published->timestamp = captured.captureTime;
+    latestFrame_.publish(std::move(published));
+    
+    if (broadcast) {
+        broadcastBytesCopied_ += shared->payload.size();
+        passthroughFrames_++;
+        tileKeyframePending_ = true;  // 直通帧不更新分块参考帧，恢复分块模式时从关键帧开始
+        pushEncodedFrame(std::move(shared));
+    }
+    return true;
+}
+
+bool VideoStreamer::needsDecodedFrames() const {
+    // 叠加绘制、畸变校正、鸟瞰视图和标定都需要像素数据；降档的连接需要重新编码
+    return calibrationMode_ || arucoMode_ || cameraCalibrationMode_ || autoCapturing_ ||
+           isFrameCorrectionActive() || degradedClients_ > 0 || birdsEyeClients_ > 0;
+}
+
+void VideoStreamer::setMjpegPassthroughEnabled(bool enabled) {
+    mjpegPassthroughEnabled_ = enabled;
+    if (enabled) {
+        mjpegPassthroughSupported_ = true;  // 重新尝试
+    }
+    std::cout << "🎞️ [MJPEG PASSTHROUGH] Set to: " << (enabled ? "enabled" : "disabled") << std::endl;
+}
+
+bool VideoStreamer::isMjpegPassthroughEnabled() const {
+    return mjpegPassthroughEnabled_;
+}
+
+bool VideoStreamer::isMjpegPassthroughActive() const {
+    return mjpegPassthroughActive_;
+}
+
+bool VideoStreamer::needsFullResolutionFrames() {
+    // 标定点击坐标、ArUco检测和标定图像采集都基于全分辨率；分块传输和关闭自适应质量时按全分辨率推流
+    if (calibrationMode_ || arucoMode_ || autoCapturing_ || tiledStreaming_ || !adaptiveQualityEnabled_) {
+        return true;
+    }
+    
+    // 有连接的档位分辨率高于显示分辨率时需要全分辨率
+    std::lock_guard<std::mutex> lock(conn_mutex_);
+    for (const auto& entry : clientStates_) {
+        if (kQualityTiers[entry.second.tier].scale * width_ > displayWidth_) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VideoStreamer::undistortCapturedFrame(cv::Mat& frame, cv::Mat& displayFrame) {
+    // 输出分辨率不超过采集分辨率，不做放大
+    cv::Size captureSize = frame.size();
+    auto clampToCapture = [&captureSize](int width, int height) {
+        if (width <= 0 || height <= 0 || width > captureSize.width || height > captureSize.height) {
+            return captureSize;
+        }
+        return cv::Size(width, height);
+    };
+    cv::Size detectionSize = clampToCapture(detectionWidth_, detectionHeight_);
+    cv::Size displaySize = clampToCapture(displayWidth_, displayHeight_);
+    
+    // 校正与缩放合并为一次 remap：没有消费者需要全分辨率时直接输出显示分辨率
+    cv::Size mainSize = needsFullResolutionFrames() ? detectionSize : displaySize;
+    auto requestAge = std::chrono::steady_clock::now().time_since_epoch().count() - displayFrameRequestTime_;
+    bool displayRequested = requestAge < std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(2)).count();
+    bool separateDisplay = displayRequested && mainSize != displaySize;
+    
+    // 只保留当前用到的映射表，全分辨率映射表在不需要时释放
+    std::vector<cv::Size> outputSizes{mainSize};
+    if (separateDisplay) {
+        outputSizes.push_back(displaySize);
+    }
+    if (outputSizes != undistortOutputSizes_) {
+        cameraCalibrator_.retainUndistortMaps(outputSizes);
+        undistortOutputSizes_ = outputSizes;
+        std::cout << "📐 [UNDISTORT] Output resolution " << mainSize.width << "x" << mainSize.height
+                  << (separateDisplay ? " + display " + std::to_string(displaySize.width) + "x" + std::to_string(displaySize.height) : "")
+                  << std::endl;
+    }
+    
+    try {
+        auto undistortStart = std::chrono::high_resolution_clock::now();
+        
+        cv::Mat undistortedFrame = cameraCalibrator_.undistortImage(frame, mainSize);
+        if (separateDisplay) {
+            // 显示帧同样直接从原始帧生成，不再对校正结果做第二遍缩放
+            displayFrame = cameraCalibrator_.undistortImage(frame, displaySize);
+        }
+        
+        auto undistortEnd = std::chrono::high_resolution_clock::now();
+        double undistortTime = std::chrono::duration<double, std::milli>(undistortEnd - undistortStart).count();
+        
+        // 验证去畸变结果是否有效
+        if (undistortedFrame.empty() || undistortedFrame.size() != mainSize) {
+            cerr << "Warning: Undistortion returned invalid result, using original frame" << endl;
+            displayFrame.release();
+            return false;
+        }
+        frame = undistortedFrame;
+        if (mainSize == displaySize) {
+            displayFrame = frame;
+        } else if (displayFrame.size() != displaySize) {
+            displayFrame.release();
+        }
+        
+        // 性能日志（每10秒输出一次）
+        static auto lastUndistortLog = std::chrono::steady_clock::now();
+        auto undistortLogTime = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::seconds>(undistortLogTime - lastUndistortLog).count() >= 10) {
+            std::cout << "📊 [PERFORMANCE] Undistortion time: " << undistortTime << "ms" << std::endl;
+            lastUndistortLog = undistortLogTime;
+        }
+        return true;
+    } catch (const cv::Exception& e) {
+        cerr << "OpenCV error in undistortion: " << e.what() << endl;
+        // 继续使用原始帧，不进行去畸变
+    } catch (const std::exception& e) {
+        cerr << "Error in undistortion: " << e.what() << endl;
+        // 继续使用原始帧，不进行去畸变
+    }
+    displayFrame.release();
+    return false;
+}
+
+bool VideoStreamer::renderBirdsEyeFrame(const cv::Mat& rawFrame, cv::Mat& birdsEyeFrame) {
+    cv::Mat inverse = homographyMapper_.getInverseHomographyMatrix();
+    if (!homographyMapper_.isCalibrated() || inverse.rows != 3 || inverse.cols != 3) {
+        return false;
+    }
+    
+    try {
+        cv::Mat_<double> inverse64;
+        inverse.convertTo(inverse64, CV_64F);
+        cv::Matx33d groundToImage(inverse64.ptr<double>());
+        
+        // 补全自动参数：范围取标定点地面坐标的外接矩形并向四周扩展，比例使输出适合显示分辨率
+        BirdsEyeView::Config config;
+        {
+            std::lock_guard<std::mutex> lock(birdsEyeMutex_);
+            config = birdsEyeRequested_;
+        }
+        if (config.groundBounds.width <= 0.0f || config.groundBounds.height <= 0.0f) {
+            const auto points = homographyMapper_.getCalibrationPoints();
+            if (points.size() >= 2) {
+                cv::Point2f minPoint = points[0].second;
+                cv::Point2f maxPoint = points[0].second;
+                for (const auto& pair : points) {
+                    minPoint.x = std::min(minPoint.x, pair.second.x);
+                    minPoint.y = std::min(minPoint.y, pair.second.y);
+                    maxPoint.x = std::max(maxPoint.x, pair.second.x);
+                    maxPoint.y = std::max(maxPoint.y, pair.second.y);
+                }
+                float pad = std::max(maxPoint.x - minPoint.x, maxPoint.y - minPoint.y) * 0.25f;
+                config.groundBounds = cv::Rect2f(minPoint.x - pad, minPoint.y - pad,
+                                                 maxPoint.x - minPoint.x + 2 * pad, maxPoint.y - minPoint.y + 2 * pad);
+            }
+        }
+        if (config.mmPerPixel <= 0.0 && displayWidth_ > 0 && displayHeight_ > 0) {
+            config.mmPerPixel = std::max(config.groundBounds.width / displayWidth_,
+                                         config.groundBounds.height / displayHeight_);
+        }
+        
+        // 单应性矩阵工作在无畸变坐标中（Frame 与 Points 校正方式相同）；关闭校正时直接作用在原始像素上
+        cv::Mat cameraMatrix, distCoeffs;
+        uint64_t calibrationVersion = 0;
+        if (!cameraCorrectionEnabled_ ||
+            !cameraCalibrator_.getCalibrationSnapshot(cameraMatrix, distCoeffs, calibrationVersion)) {
+            cameraMatrix.release();
+            distCoeffs.release();
+        }
+        
+        bool ready = birdsEyeView_.prepare(config, groundToImage, rawFrame.size(), cameraMatrix, distCoeffs,
+                                           calibrationVersion);
+        birdsEyeWidth_ = birdsEyeView_.outputSize().width;
+        birdsEyeHeight_ = birdsEyeView_.outputSize().height;
+        {
+            std::lock_guard<std::mutex> lock(birdsEyeMutex_);
+            birdsEyeActive_ = config;
+        }
+        if (!ready || !birdsEyeView_.warp(rawFrame, birdsEyeFrame)) {
+            return false;
+        }
+        
+        std::ostringstream label;
+        label << "Bird's-eye " << std::fixed << std::setprecision(1) << config.mmPerPixel << " mm/px";
+        cv::putText(birdsEyeFrame, label.str(), cv::Point(10, birdsEyeFrame.rows - 20),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(226, 43, 138), 1, cv::LINE_AA); // 紫色 (138, 43, 226) 表示成功
+        return true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "OpenCV error in birds-eye view: " << e.what() << std::endl;
+        birdsEyeFrame.release();
+        return false;
+    }
+}
+
+bool VideoStreamer::processCapturedFrame(CapturedFrame& captured) {
+    // 采集阶段已把帧的所有权交给处理阶段，这里无需再复制
+    cv::Mat& processedFrame = captured.image;
+    
+    // 鸟瞰视图直接从未去畸变的原始帧生成（畸变校正已合并进映射表），须在整帧校正之前
+    cv::Mat birdsEyeFrame;
+    if (birdsEyeClients_ > 0) {
+        renderBirdsEyeFrame(processedFrame, birdsEyeFrame);
+    }
+    
+    // 性能优化：只在相机校正启用且已标定时才进行畸变校正
+    // 并且不在标定模式下进行校正（标定需要原始畸变图像）；Points 模式下只校正坐标，跳过整帧 remap
+    cv::Mat displayFrame;
+    if (isFrameCorrectionActive()) {
+        undistortCapturedFrame(processedFrame, displayFrame);
+    }
+    
+    // 离开相机标定模式后丢弃跟踪状态，下次进入时重新检测
+    if (!cameraCalibrationMode_ && chessboardTracker_.isTracking()) {
+        chessboardTracker_.clear();
+    }
+    
+    // 如果处于相机标定模式，使用轻量级显示处理
+    if (cameraCalibrationMode_) {
+        try {
+            // 性能优化：降低标定模式下的检测频率
+            static int detectionCounter = 0;
+            detectionCounter++;
+            
+            // 在显示分辨率的灰度帧上跟踪/检测（低精度，快速）
+            cv::Mat displayGray;
+            if (processedFrame.cols != displayWidth_ || processedFrame.rows != displayHeight_) {
+                cv::Mat displayFrame;
+                cv::resize(processedFrame, displayFrame, cv::Size(displayWidth_, displayHeight_));
+                cv::cvtColor(displayFrame, displayGray, cv::COLOR_BGR2GRAY);
+            } else {
+                cv::cvtColor(processedFrame, displayGray, cv::COLOR_BGR2GRAY);
+            }
+            
+            cv::Size boardSize = cameraCalibrator_.getBoardSize();
+            std::vector<cv::Point2f> corners;
+            bool found = false;
+            
+            // 已检测到棋盘格时用光流逐帧跟踪角点，跟踪失败后才回到完整检测；
+            // 连续跟踪 kChessboardRedetectFrames 帧后强制完整检测一次，消除跟踪的累积漂移
+            const int kChessboardRedetectFrames = 30;
+            bool forceDetection = false;
+            if (chessboardTracker_.isTracking() && chessboardTracker_.boardSize() == boardSize) {
+                if (chessboardTracker_.trackedFrames() >= kChessboardRedetectFrames) {
+                    forceDetection = true;
+                } else {
+                    found = chessboardTracker_.update(displayGray, corners);
+                }
+            }
+            
+            // 完整检测每3帧才进行一次，减少CPU负载
+            if (!found && (forceDetection || detectionCounter % 3 == 0)) {
+                // 使用更宽松的检测条件进行快速检测
+                int quickFlags = cv::CALIB_CB_ADAPTIVE_THRESH;
+                found = cv::findChessboardCorners(displayGray, boardSize, corners, quickFlags);
+                if (found) {
+                    chessboardTracker_.reset(displayGray, boardSize, corners);
+                } else {
+                    chessboardTracker_.clear();
+                }
+            }
+            
+            if (found) {
+                // 缩放角点坐标回原始帧比例（用于精确显示）
+                float scaleX = (float)processedFrame.cols / displayWidth_;
+                float scaleY = (float)processedFrame.rows / displayHeight_;
+                for (auto& corner : corners) {
+                    corner.x *= scaleX;
+                    corner.y *= scaleY;
+                }
+                
+                cv::drawChessboardCorners(processedFrame, boardSize, corners, found);
+                cv::putText(processedFrame, "Chessboard OK", cv::Point(processedFrame.cols - 160, 30),
+                          cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(226, 43, 138), 2, cv::LINE_AA); // 紫色 (138, 43, 226) 表示成功
+            } else {
+                cv::putText(processedFrame, "Searching...", cv::Point(processedFrame.cols - 150, 30),
+                          cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 100, 255), 2, cv::LINE_AA);
+            }
+            
+            // 显示当前校正状态
+            if (cameraCorrectionEnabled_ && isCameraCalibrated()) {
+                cv::putText(processedFrame, "Correction: OFF (Calibration Mode)", cv::Point(10, processedFrame.rows - 20),
+                          cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 165, 0), 1, cv::LINE_AA);
+            }
+            
+        } catch (const std::exception& e) {
+            cerr << "Error in chessboard visualization: " << e.what() << endl;
+        }
+    } else if (calibrationMode_) {
+        // 坐标变换标定模式的简洁提示
+                            cv::putText(processedFrame, "Click to add point", cv::Point(processedFrame.cols - 180, 30),
+                  cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 149, 255), 2, cv::LINE_AA); // 橙色 (255, 149, 0) 表示提示
+    } else {
+        // 正常模式：显示校正状态
+        if (isFrameCorrectionActive()) {
+            cv::putText(processedFrame, "Correction: ON", cv::Point(10, processedFrame.rows - 20),
+                      cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(226, 43, 138), 1, cv::LINE_AA); // 紫色 (138, 43, 226) 表示成功
+        } else if (isPointCorrectionActive()) {
+            cv::putText(processedFrame, "Correction: POINTS", cv::Point(10, processedFrame.rows - 20),
+                      cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(226, 43, 138), 1, cv::LINE_AA);
+        } else if (isCameraCalibrated()) {
+            cv::putText(processedFrame, "Correction: OFF", cv::Point(10, processedFrame.rows - 20),
+                      cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(112, 25, 25), 1, cv::LINE_AA); // 深蓝色 (25, 25, 112) 表示错误
+        }
+    }
+    
+    // 验证processedFrame的有效性
+    if (processedFrame.empty() || processedFrame.cols <= 0 || processedFrame.rows <= 0) {
+        std::cerr << "Warning: Invalid processedFrame, skipping frame update" << std::endl;
+        return false;
+    }
+    
+    // 发布为最新帧：显示与检测共享同一份只读数据，不再复制
+    auto published = std::make_shared<Frame>();
+    published->image = std::move(processedFrame);
+    published->display = std::move(displayFrame);
+    published->birdsEye = std::move(birdsEyeFrame);
+    published->sequence = captured.sequence;
+    published->timestamp = captured.captureTime;
+    FramePtr snapshot = std::move(published);
+    latestFrame_.publish(snapshot);
+    
+    // ArUco 检测在后台线程中进行，不阻塞处理和广播
+    if (arucoMode_) {
+        arucoWorker_.submit(std::move(snapshot));
+    }
+    
+    return true;
+}
+
 // 相机标定相关方法实现
 bool VideoStreamer::isCameraCalibrationMode() const {
     return cameraCalibrationMode_;
@@ -1331,7 +2557,10 @@ bool VideoStreamer::addCameraCalibrationImage() {
     cv::Mat detectionFrame;
     
     try {
-        detectionFrame = getDetectionFrame();
+        FramePtr snapshot = getDetectionFrame();
+        if (snapshot) {
+            detectionFrame = snapshot->image;  // 只读使用，无需复制
+        }
         
         if (detectionFrame.empty()) {
             std::cerr << "No detection frame available for calibration" << std::endl;
@@ -1375,6 +2604,18 @@ bool VideoStreamer::loadCameraCalibrationData(const std::string& filename) {
     return cameraCalibrator_.loadCalibrationData(filepath);
 }
 
+void VideoStreamer::setUndistortThreadCount(int count) {
+    cameraCalibrator_.setUndistortThreadCount(count);
+}
+
+int VideoStreamer::getUndistortThreadCount() const {
+    return cameraCalibrator_.getUndistortThreadCount();
+}
+
+cv::Mat VideoStreamer::undistortImage(const cv::Mat& image) {
+    return cameraCalibrator_.undistortImage(image);
+}
+
 cv::Mat VideoStreamer::getCameraMatrix() const {
     return cameraCalibrator_.getCameraMatrix();
 }
@@ -1402,6 +2643,22 @@ size_t VideoStreamer::getCalibrationImageCount() const {
     return cameraCalibrator_.getImageCount();
 }
 
+void VideoStreamer::setParallelChessboardDetectionEnabled(bool enabled) {
+    cameraCalibrator_.setParallelDetectionEnabled(enabled);
+}
+
+bool VideoStreamer::isParallelChessboardDetectionEnabled() const {
+    return cameraCalibrator_.isParallelDetectionEnabled();
+}
+
+std::vector<CameraCalibrator::ChessboardStrategyStats> VideoStreamer::getChessboardStrategyStats() const {
+    return cameraCalibrator_.getChessboardStrategyStats();
+}
+
+CalibrationImageWriter::Stats VideoStreamer::getCalibrationWriterStats() const {
+    return cameraCalibrator_.getImageWriterStats();
+}
+
 void VideoStreamer::setChessboardSize(int width, int height) {
     cameraCalibrator_.setChessboardSize(width, height);
 }
@@ -1532,7 +2789,8 @@ void VideoStreamer::autoCalibrationCaptureThread(int durationSeconds, int interv
     // 循环直到达到结束时间或停止标志被设置
     while (autoCapturing_ && std::chrono::steady_clock::now() < endTime) {
         // 获取用于检测的高分辨率帧
-        cv::Mat detectionFrame = getDetectionFrame();
+        FramePtr snapshot = getDetectionFrame();
+        cv::Mat detectionFrame = snapshot ? snapshot->image : cv::Mat();
         
         if (!detectionFrame.empty()) {
             attemptCount++;
@@ -1541,9 +2799,11 @@ void VideoStreamer::autoCalibrationCaptureThread(int durationSeconds, int interv
             
             // 尝试检测棋盘格并添加标定图像
             std::vector<cv::Point2f> corners;
-            bool found = cameraCalibrator_.detectChessboard(detectionFrame, corners, true);  // 使用完整的调试检测
+            CameraCalibrator::ChessboardStrategy strategy = CameraCalibrator::ChessboardStrategy::None;
+            bool found = cameraCalibrator_.detectChessboard(detectionFrame, corners, true, &strategy);  // 使用完整的调试检测
             
-            std::cout << "Chessboard detection result: " << (found ? "SUCCESS" : "FAILED") << std::endl;
+            std::cout << "Chessboard detection result: " << (found ? "SUCCESS" : "FAILED")
+                      << " (strategy: " << CameraCalibrator::chessboardStrategyName(strategy) << ")" << std::endl;
             if (found) {
                 std::cout << "Detected " << corners.size() << " corners" << std::endl;
                 
@@ -1651,92 +2911,108 @@ void VideoStreamer::setDetectionResolution(int width, int height) {
     detectionHeight_ = height;
 }
 
-cv::Mat VideoStreamer::getDisplayFrame() {
-    std::lock_guard<std::mutex> lock(mutex_);
+FramePtr VideoStreamer::getDisplayFrame() {
+    FramePtr snapshot = currentFrame();
     
     // 多重安全检查
-    if (frame_.empty()) {
-        return cv::Mat();
+    if (!snapshot || snapshot->image.empty()) {
+        return nullptr;
+    }
+    
+    if (snapshot->image.cols <= 0 || snapshot->image.rows <= 0) {
+        std::cerr << "Warning: latest frame has invalid dimensions: " 
+                  << snapshot->image.cols << "x" << snapshot->image.rows << std::endl;
+        return nullptr;
+    }
+    
+    // 登记显示消费者：校正启用时处理阶段会直接生成显示分辨率的帧
+    displayFrameRequestTime_ = std::chrono::steady_clock::now().time_since_epoch().count();
+    
+    // 分辨率与显示分辨率一致时直接返回共享快照
+    if (snapshot->image.cols == displayWidth_ && snapshot->image.rows == displayHeight_) {
+        return snapshot;
     }
     
-    if (frame_.cols <= 0 || frame_.rows <= 0) {
-        std::cerr << "Warning: frame_ has invalid dimensions: " 
-                  << frame_.cols << "x" << frame_.rows << std::endl;
-        return cv::Mat();
+    // 处理阶段已生成显示分辨率的校正帧，共享其像素数据
+    if (snapshot->display.cols == displayWidth_ && snapshot->display.rows == displayHeight_) {
+        auto displayFrame = std::make_shared<Frame>();
+        displayFrame->image = snapshot->display;
+        displayFrame->sequence = snapshot->sequence;
+        displayFrame->timestamp = snapshot->timestamp;
+        return displayFrame;
     }
     
     try {
-        // 如果当前帧分辨率与显示分辨率不同，进行缩放
-        if (frame_.cols != displayWidth_ || frame_.rows != displayHeight_) {
-            cv::Mat displayFrame;
-            cv::resize(frame_, displayFrame, cv::Size(displayWidth_, displayHeight_));
-            
-            // 验证缩放结果
-            if (displayFrame.empty()) {
-                std::cerr << "Error: Frame resize operation failed" << std::endl;
-                return cv::Mat();
-            }
-            
-            return displayFrame;
-        }
-        
-        // 安全的深度复制
-        cv::Mat result = frame_.clone();
+        // 当前帧分辨率与显示分辨率不同，缩放到新的帧中
+        auto displayFrame = std::make_shared<Frame>();
+        displayFrame->image = FramePool::instance().acquire(cv::Size(displayWidth_, displayHeight_), snapshot->image.type());
+        cv::resize(snapshot->image, displayFrame->image, cv::Size(displayWidth_, displayHeight_));
+        displayFrame->sequence = snapshot->sequence;
+        displayFrame->timestamp = snapshot->timestamp;
         
-        // 验证克隆结果
-        if (result.empty()) {
-            std::cerr << "Error: Frame clone operation failed" << std::endl;
-            return cv::Mat();
+        // 验证缩放结果
+        if (displayFrame->image.empty()) {
+            std::cerr << "Error: Frame resize operation failed" << std::endl;
+            return nullptr;
         }
         
-        return result;
+        return displayFrame;
         
     } catch (const cv::Exception& e) {
         std::cerr << "OpenCV error in getDisplayFrame: " << e.what() << std::endl;
-        return cv::Mat();
+        return nullptr;
     } catch (const std::exception& e) {
         std::cerr << "Error in getDisplayFrame: " << e.what() << std::endl;
-        return cv::Mat();
+        return nullptr;
     }
 }
 
-cv::Mat VideoStreamer::getDetectionFrame() {
-    std::lock_guard<std::mutex> lock(mutex_);
+FramePtr VideoStreamer::getDetectionFrame() const {
+    FramePtr snapshot = currentFrame();
     
     // 多重安全检查
-    if (detectionFrame_.empty()) {
-        std::cerr << "Warning: detectionFrame_ is empty" << std::endl;
-        return cv::Mat();
+    if (!snapshot || snapshot->image.empty()) {
+        std::cerr << "Warning: detection frame is empty" << std::endl;
+        return nullptr;
     }
     
-    if (detectionFrame_.cols <= 0 || detectionFrame_.rows <= 0) {
-        std::cerr << "Warning: detectionFrame_ has invalid dimensions: " 
-                  << detectionFrame_.cols << "x" << detectionFrame_.rows << std::endl;
-        return cv::Mat();
+    if (snapshot->image.cols <= 0 || snapshot->image.rows <= 0) {
+        std::cerr << "Warning: detection frame has invalid dimensions: " 
+                  << snapshot->image.cols << "x" << snapshot->image.rows << std::endl;
+        return nullptr;
     }
     
-    try {
-        // 安全的深度复制
-        cv::Mat result = detectionFrame_.clone();
-        
-        // 验证克隆结果
-        if (result.empty() || result.cols <= 0 || result.rows <= 0) {
-            std::cerr << "Error: Frame clone operation failed" << std::endl;
-            return cv::Mat();
-        }
-        
-        return result;
-        
-    } catch (const cv::Exception& e) {
-        std::cerr << "OpenCV error in getDetectionFrame: " << e.what() << std::endl;
-        return cv::Mat();
-    } catch (const std::exception& e) {
-        std::cerr << "Error in getDetectionFrame: " << e.what() << std::endl;
-        return cv::Mat();
-    }
+    return snapshot;
 }
 
 // 相机校正控制方法
+void VideoStreamer::setCorrectionMode(CorrectionMode mode) {
+    correctionMode_ = mode;
+    std::cout << "📸 [CAMERA CORRECTION] Mode: " << (mode == CorrectionMode::Frame ? "frame" : "points") << std::endl;
+}
+
+VideoStreamer::CorrectionMode VideoStreamer::getCorrectionMode() const {
+    return correctionMode_;
+}
+
+void VideoStreamer::setCorrectedVideoRequested(bool requested) {
+    correctedVideoRequested_ = requested;
+}
+
+bool VideoStreamer::isCorrectedVideoRequested() const {
+    return correctedVideoRequested_;
+}
+
+bool VideoStreamer::isFrameCorrectionActive() const {
+    // 相机标定模式需要原始畸变图像，不做整帧校正
+    return cameraCorrectionEnabled_ && !cameraCalibrationMode_ && isCameraCalibrated() &&
+           (correctionMode_ == CorrectionMode::Frame || correctedVideoRequested_);
+}
+
+bool VideoStreamer::isPointCorrectionActive() const {
+    return cameraCorrectionEnabled_ && isCameraCalibrated() && !isFrameCorrectionActive();
+}
+
 void VideoStreamer::setCameraCorrectionEnabled(bool enabled) {
     cameraCorrectionEnabled_ = enabled;
     std::cout << "📸 [CAMERA CORRECTION] Set to: " << (enabled ? "enabled" : "disabled") << std::endl;
@@ -1823,24 +3099,38 @@ std::string VideoStreamer::getSystemResourceInfo() {
 // ArUco 检测参数设置方法实现
 void VideoStreamer::setArUcoDetectionParameters(int adaptiveThreshWinSizeMin, int adaptiveThreshWinSizeMax, 
                                                int adaptiveThreshWinSizeStep, double adaptiveThreshConstant) {
+    std::lock_guard<std::mutex> lock(arucoDetectMutex_);
     homographyMapper_.setDetectionParameters(adaptiveThreshWinSizeMin, adaptiveThreshWinSizeMax, 
                                            adaptiveThreshWinSizeStep, adaptiveThreshConstant);
 }
 
 void VideoStreamer::setArUcoCornerRefinementMethod(int method) {
+    std::lock_guard<std::mutex> lock(arucoDetectMutex_);
     homographyMapper_.setCornerRefinementMethod(method);
 }
 
 void VideoStreamer::getArUcoDetectionParameters(int& adaptiveThreshWinSizeMin, int& adaptiveThreshWinSizeMax, 
                                                int& adaptiveThreshWinSizeStep, double& adaptiveThreshConstant) const {
+    std::lock_guard<std::mutex> lock(arucoDetectMutex_);
     homographyMapper_.getDetectionParameters(adaptiveThreshWinSizeMin, adaptiveThreshWinSizeMax, 
                                            adaptiveThreshWinSizeStep, adaptiveThreshConstant);
 }
 
 int VideoStreamer::getArUcoCornerRefinementMethod() const {
+    std::lock_guard<std::mutex> lock(arucoDetectMutex_);
     return homographyMapper_.getCornerRefinementMethod();
 }
 
+void VideoStreamer::setArUcoDetectionScale(double scale) {
+    std::lock_guard<std::mutex> lock(arucoDetectMutex_);
+    homographyMapper_.setArUcoDetectionScale(scale);
+}
+
+double VideoStreamer::getArUcoDetectionScale() const {
+    std::lock_guard<std::mutex> lock(arucoDetectMutex_);
+    return homographyMapper_.getArUcoDetectionScale();
+}
+
 // 坐标变换标定模式控制方法实现
 bool VideoStreamer::toggleCalibrationMode() {
     calibrationMode_ = !calibrationMode_;
@@ -1882,6 +3172,32 @@ void VideoStreamer::sendErrorNotification(const std::string& errorType, const st
 void VideoStreamer::attemptCameraRecovery() {
     std::cout << "🔧 [CAMERA RECOVERY] 尝试恢复摄像头设备..." << std::endl;
     
+    // 独立采集后端：在原对象上关闭后按上次成功的配置重新打开，始终使用同一种后端
+    if (captureBackendType_ != CaptureBackendType::OpenCV) {
+        {
+            std::lock_guard<std::mutex> lock(captureBackendMutex_);
+            if (captureBackend_) {
+                captureBackend_->close();
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(500)); // 等待资源释放
+        bool reopened = false;
+        {
+            std::lock_guard<std::mutex> lock(captureBackendMutex_);
+            reopened = captureBackend_ && captureBackend_->open(captureConfig_);
+        }
+        if (reopened) {
+            frameReadFailureCount_ = 0;
+            std::cout << "✅ [CAMERA RECOVERY] 摄像头恢复成功" << std::endl;
+            sendErrorNotification("camera_recovery_success", "摄像头恢复成功", "设备重新初始化完成");
+        } else {
+            std::cout << "❌ [CAMERA RECOVERY] 摄像头恢复失败" << std::endl;
+            sendErrorNotification("camera_recovery_failed", "摄像头恢复失败", 
+                                "无法重新初始化摄像头，请检查设备连接或重启程序");
+        }
+        return;
+    }
+    
     // 释放当前摄像头资源
     if (cap_.isOpened()) {
         cap_.release();
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <chrono>
 #include <thread>
+#include <cstdlib>
 
 using namespace std;
 
@@ -18,6 +19,41 @@ int main(int argc, char** argv) {
     // Create video streamer
     VideoStreamer streamer;
     
+    // 采集后端选择：--capture=opencv|v4l2|fake --device=<路径> --buffers=<数量>
+    // fake 后端从 JPEG 文件/目录或 .yuv 原始文件读取，便于在没有摄像头的机器上测试
+    // 并行去畸变线程数：--undistort-threads=<数量>
+    // 图像→地面查找表：--ground-lut=<网格间距>（1 为逐像素稠密表，0 或不指定则不启用）
+    // ArUco 后台检测频率上限：--aruco-fps=<次/秒>（0 或不指定则不限，与推流帧率无关）
+    int groundLutCellSize = 0;
+    {
+        CaptureBackendType backendType = CaptureBackendType::OpenCV;
+        std::string device;
+        int bufferCount = 4;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--capture=v4l2") {
+                backendType = CaptureBackendType::V4L2Mmap;
+            } else if (arg == "--capture=fake") {
+                backendType = CaptureBackendType::FakeFile;
+            } else if (arg == "--capture=opencv") {
+                backendType = CaptureBackendType::OpenCV;
+            } else if (arg.rfind("--device=", 0) == 0) {
+                device = arg.substr(9);
+            } else if (arg.rfind("--buffers=", 0) == 0) {
+                bufferCount = std::atoi(arg.c_str() + 10);
+            } else if (arg.rfind("--undistort-threads=", 0) == 0) {
+                streamer.setUndistortThreadCount(std::atoi(arg.c_str() + 20));
+            } else if (arg.rfind("--ground-lut=", 0) == 0) {
+                groundLutCellSize = std::atoi(arg.c_str() + 13);
+            } else if (arg.rfind("--aruco-fps=", 0) == 0) {
+                streamer.setArUcoDetectionRate(std::atof(arg.c_str() + 12));
+            } else {
+                cerr << "Unknown argument: " << arg << endl;
+            }
+        }
+        streamer.setCaptureBackend(backendType, device, bufferCount);
+    }
+    
     // 初始化摄像头 
     // 这里 -1 表示自动检测使用第一个可用的摄像头设备，1920x1080 是分辨率，30 是帧率
     cout << "Detecting camera devices..." << endl;
@@ -25,6 +61,10 @@ int main(int argc, char** argv) {
         cerr << "Failed to initialize camera" << endl;
         return -1;
     }
+    // 查找表按实际采集分辨率生成，必须在摄像头初始化之后启用
+    if (groundLutCellSize > 0) {
+        streamer.enableGroundLookupTable(groundLutCellSize);
+    }
 
     // Start video stream
     streamer.start();
@@ -52,6 +92,12 @@ int main(int argc, char** argv) {
     .onmessage([&streamer](crow::websocket::connection& conn, const std::string& data, bool is_binary) {
         // 处理来自客户端的消息
         if (!is_binary) {
+            // 帧确认与帧率同频，直接交给自适应质量控制器，不解析也不记录日志
+            if (data.find("\"action\":\"frame_ack\"") != std::string::npos) {
+                streamer.acknowledgeFrame(&conn);
+                return;
+            }
+            
             std::cout << "Received text message: " << data << std::endl;
             
             try {
@@ -654,6 +700,112 @@ int main(int argc, char** argv) {
                                          "\"status_refresh\": true}";
                     conn.send_text(response);
                     
+                } else if (action == "toggle_tiled_streaming") {
+                    // 切换分块传输模式（只发送变化的块）
+                    bool enabled = !streamer.isTiledStreaming();
+                    
+                    // 解析可选的enabled字段，缺省时切换当前状态
+                    size_t enabled_pos = data.find("\"enabled\":");
+                    if (enabled_pos != std::string::npos) {
+                        size_t value_start = enabled_pos + 10;
+                        enabled = data.substr(value_start, 4) == "true";
+                    }
+                    streamer.setTiledStreaming(enabled);
+                    std::string response = "{\"type\":\"tiled_streaming_status\",\"enabled\":" +
+                                           std::string(streamer.isTiledStreaming() ? "true" : "false") + "}";
+                    conn.send_text(response);
+                    
+                } else if (action == "toggle_adaptive_quality") {
+                    // 切换按连接自适应质量
+                    bool enabled = !streamer.isAdaptiveQualityEnabled();
+                    
+                    // 解析可选的enabled字段，缺省时切换当前状态
+                    size_t enabled_pos = data.find("\"enabled\":");
+                    if (enabled_pos != std::string::npos) {
+                        size_t value_start = enabled_pos + 10;
+                        enabled = data.substr(value_start, 4) == "true";
+                    }
+                    streamer.setAdaptiveQualityEnabled(enabled);
+                    std::string response = "{\"type\":\"adaptive_quality_status\",\"enabled\":" +
+                                           std::string(streamer.isAdaptiveQualityEnabled() ? "true" : "false") + "}";
+                    conn.send_text(response);
+                    
+                } else if (action == "get_client_quality_stats") {
+                    // 返回每个连接当前的质量档位与积压情况
+                    std::string clients;
+                    for (const auto& client : streamer.getClientQualityStats()) {
+                        if (!clients.empty()) clients += ",";
+                        clients += "{\"tier\":" + std::to_string(client.tier) + ","
+                                   "\"quality\":" + std::to_string(client.quality) + ","
+                                   "\"scale\":" + std::to_string(client.scale) + ","
+                                   "\"frame_skip\":" + std::to_string(client.frameSkip) + ","
+                                   "\"frames_in_flight\":" + std::to_string(client.framesInFlight) + ","
+                                   "\"outstanding_bytes\":" + std::to_string(client.outstandingBytes) + ","
+                                   "\"ack_latency_ms\":" + std::to_string(client.ackLatencyMs) + ","
+                                   "\"acknowledging\":" + std::string(client.acknowledging ? "true" : "false") + "}";
+                    }
+                    std::string response = "{\"type\":\"client_quality_stats\",\"clients\":[" + clients + "]}";
+                    conn.send_text(response);
+                    
+                } else if (action == "toggle_parallel_chessboard_detection") {
+                    // 切换棋盘格回退策略的并行检测
+                    bool enabled = !streamer.isParallelChessboardDetectionEnabled();
+                    
+                    // 解析可选的enabled字段，缺省时切换当前状态
+                    size_t enabled_pos = data.find("\"enabled\":");
+                    if (enabled_pos != std::string::npos) {
+                        size_t value_start = enabled_pos + 10;
+                        enabled = data.substr(value_start, 4) == "true";
+                    }
+                    streamer.setParallelChessboardDetectionEnabled(enabled);
+                    
+                    std::string response = "{\"type\":\"parallel_chessboard_detection_toggled\","
+                                         "\"enabled\":" + std::string(streamer.isParallelChessboardDetectionEnabled() ? "true" : "false") + "}";
+                    conn.send_text(response);
+                    
+                } else if (action == "get_chessboard_strategy_stats") {
+                    // 返回各检测策略的尝试次数、成功次数和平均耗时
+                    std::string strategies;
+                    for (const auto& stats : streamer.getChessboardStrategyStats()) {
+                        if (!strategies.empty()) strategies += ",";
+                        strategies += "{\"name\":\"" + stats.name + "\","
+                                      "\"attempts\":" + std::to_string(stats.attempts) + ","
+                                      "\"wins\":" + std::to_string(stats.wins) + ","
+                                      "\"average_ms\":" + std::to_string(stats.averageMs) + "}";
+                    }
+                    std::string response = "{\"type\":\"chessboard_strategy_stats\","
+                                         "\"parallel\":" + std::string(streamer.isParallelChessboardDetectionEnabled() ? "true" : "false") + ","
+                                         "\"strategies\":[" + strategies + "]}";
+                    conn.send_text(response);
+                    
+                } else if (action == "get_calibration_writer_stats") {
+                    // 返回标定图像后台写入队列的状态
+                    CalibrationImageWriter::Stats stats = streamer.getCalibrationWriterStats();
+                    std::string response = "{\"type\":\"calibration_writer_stats\","
+                                         "\"queue_depth\":" + std::to_string(stats.queueDepth) + ","
+                                         "\"queue_capacity\":" + std::to_string(stats.capacity) + ","
+                                         "\"written\":" + std::to_string(stats.written) + ","
+                                         "\"failed\":" + std::to_string(stats.failed) + ","
+                                         "\"dropped\":" + std::to_string(stats.dropped) + ","
+                                         "\"last_write_ms\":" + std::to_string(stats.lastWriteMs) + ","
+                                         "\"average_write_ms\":" + std::to_string(stats.averageWriteMs) + ","
+                                         "\"max_write_ms\":" + std::to_string(stats.maxWriteMs) + "}";
+                    conn.send_text(response);
+                    
+                } else if (action == "get_pipeline_stats") {
+                    // 返回流水线各阶段的队列深度与丢帧统计
+                    std::string stages;
+                    for (const auto& stage : streamer.getPipelineStats()) {
+                        if (!stages.empty()) stages += ",";
+                        stages += "{\"name\":\"" + stage.name + "\","
+                                  "\"queue_depth\":" + std::to_string(stage.queueDepth) + ","
+                                  "\"queue_capacity\":" + std::to_string(stage.queueCapacity) + ","
+                                  "\"dropped\":" + std::to_string(stage.dropped) + ","
+                                  "\"processed\":" + std::to_string(stage.processed) + "}";
+                    }
+                    std::string response = "{\"type\":\"pipeline_stats\",\"stages\":[" + stages + "]}";
+                    conn.send_text(response);
+                    
                 } else if (action == "toggle_camera_correction") {
                     // 切换相机校正状态
                     bool enabled = false;
@@ -691,6 +843,77 @@ int main(int argc, char** argv) {
                         std::cout << "✅ [CAMERA CORRECTION] Successfully " << (enabled ? "enabled" : "disabled") << std::endl;
                     }
                     
+                } else if (action == "set_correction_mode") {
+                    // 设置校正方式：frame 整帧去畸变，points 只校正坐标
+                    // corrected_video 为 true 时即使在 points 模式下也输出整帧校正后的视频
+                    size_t mode_pos = data.find("\"mode\":\"");
+                    if (mode_pos != std::string::npos) {
+                        size_t value_start = mode_pos + 8;
+                        if (data.substr(value_start, 6) == "points") {
+                            streamer.setCorrectionMode(VideoStreamer::CorrectionMode::Points);
+                        } else if (data.substr(value_start, 5) == "frame") {
+                            streamer.setCorrectionMode(VideoStreamer::CorrectionMode::Frame);
+                        }
+                    }
+                    
+                    size_t video_pos = data.find("\"corrected_video\":");
+                    if (video_pos != std::string::npos) {
+                        streamer.setCorrectedVideoRequested(data.substr(video_pos + 18, 4) == "true");
+                    }
+                    
+                    bool pointsMode = streamer.getCorrectionMode() == VideoStreamer::CorrectionMode::Points;
+                    std::string response = "{\"type\":\"correction_mode_status\","
+                                         "\"mode\":\"" + std::string(pointsMode ? "points" : "frame") + "\","
+                                         "\"corrected_video\":" + std::string(streamer.isCorrectedVideoRequested() ? "true" : "false") + ","
+                                         "\"frame_correction\":" + std::string(streamer.isFrameCorrectionActive() ? "true" : "false") + ","
+                                         "\"point_correction\":" + std::string(streamer.isPointCorrectionActive() ? "true" : "false") + "}";
+                    conn.send_text(response);
+                    
+                } else if (action == "set_video_view") {
+                    // 选择本连接接收的画面：camera 原始画面，birds_eye 地面俯视视图
+                    size_t view_pos = data.find("\"view\":\"");
+                    if (view_pos != std::string::npos) {
+                        bool birdsEye = data.substr(view_pos + 8, 9) == "birds_eye";
+                        streamer.setClientVideoView(&conn, birdsEye ? VideoStreamer::VideoView::BirdsEye
+                                                                    : VideoStreamer::VideoView::Camera);
+                    }
+                    
+                    bool birdsEye = streamer.getClientVideoView(&conn) == VideoStreamer::VideoView::BirdsEye;
+                    std::string response = "{\"type\":\"video_view_status\","
+                                         "\"view\":\"" + std::string(birdsEye ? "birds_eye" : "camera") + "\","
+                                         "\"homography_calibrated\":" + std::string(streamer.isCalibrated() ? "true" : "false") + "}";
+                    conn.send_text(response);
+                    
+                } else if (action == "set_birds_eye_config") {
+                    // 鸟瞰视图参数：地面范围 x_min/y_min/x_max/y_max 与 mm_per_pixel，省略的参数自动选择
+                    auto readNumber = [&data](const std::string& key, double& value) {
+                        size_t pos = data.find("\"" + key + "\":");
+                        if (pos != std::string::npos) {
+                            try { value = std::stod(data.substr(pos + key.size() + 3)); } catch (...) {}
+                        }
+                    };
+                    double xMin = 0, yMin = 0, xMax = 0, yMax = 0, mmPerPixel = 0;
+                    readNumber("x_min", xMin);
+                    readNumber("y_min", yMin);
+                    readNumber("x_max", xMax);
+                    readNumber("y_max", yMax);
+                    readNumber("mm_per_pixel", mmPerPixel);
+                    cv::Rect2f bounds;
+                    if (xMax > xMin && yMax > yMin) {
+                        bounds = cv::Rect2f(static_cast<float>(xMin), static_cast<float>(yMin),
+                                            static_cast<float>(xMax - xMin), static_cast<float>(yMax - yMin));
+                    }
+                    streamer.setBirdsEyeConfig(bounds, mmPerPixel);
+                    
+                    BirdsEyeView::Config config = streamer.getBirdsEyeConfig();
+                    std::string response = "{\"type\":\"birds_eye_config_status\","
+                                         "\"x_min\":" + std::to_string(config.groundBounds.x) + ","
+                                         "\"y_min\":" + std::to_string(config.groundBounds.y) + ","
+                                         "\"x_max\":" + std::to_string(config.groundBounds.x + config.groundBounds.width) + ","
+                                         "\"y_max\":" + std::to_string(config.groundBounds.y + config.groundBounds.height) + ","
+                                         "\"mm_per_pixel\":" + std::to_string(config.mmPerPixel) + "}";
+                    conn.send_text(response);
+                    
                 } else if (action == "start_new_calibration_session") {
                     // 开始新的标定会话
                     streamer.startNewCameraCalibrationSession();
@@ -924,6 +1147,37 @@ int main(int argc, char** argv) {
                              << "), 步长(" << step << "), 常数(" << constant 
                              << "), 优化方法(" << refinement << ")" << std::endl;
                 }
+                // 设置 ArUco 两级检测的缩放比例（1 为单级全分辨率检测）
+                else if (action == "set_aruco_detection_scale") {
+                    size_t scale_pos = data.find("\"scale\":");
+                    if (scale_pos != std::string::npos) {
+                        try { streamer.setArUcoDetectionScale(std::stod(data.substr(scale_pos + 8))); } catch (...) {}
+                    }
+                    
+                    std::string response = "{\"type\":\"aruco_detection_scale_status\",\"scale\":" +
+                                           std::to_string(streamer.getArUcoDetectionScale()) + "}";
+                    conn.send_text(response);
+                }
+                // ArUco 后台检测：设置检测频率上限（0 为不限）或查询状态，两者都返回当前状态
+                else if (action == "set_aruco_detection_rate" || action == "get_aruco_detection_status") {
+                    if (action == "set_aruco_detection_rate") {
+                        size_t fps_pos = data.find("\"fps\":");
+                        if (fps_pos != std::string::npos) {
+                            try { streamer.setArUcoDetectionRate(std::stod(data.substr(fps_pos + 6))); } catch (...) {}
+                        }
+                    }
+                    
+                    VideoStreamer::ArUcoDetectionStatus status = streamer.getArUcoDetectionStatus();
+                    std::string response = "{\"type\":\"aruco_detection_status\","
+                                         "\"max_fps\":" + std::to_string(status.maxRate) + ","
+                                         "\"detections\":" + std::to_string(status.detections) + ","
+                                         "\"skipped_frames\":" + std::to_string(status.replacedFrames) + ","
+                                         "\"last_detect_ms\":" + std::to_string(status.lastDetectMs) + ","
+                                         "\"avg_detect_ms\":" + std::to_string(status.averageDetectMs) + ","
+                                         "\"result_age_frames\":" + std::to_string(status.resultAgeFrames) + ","
+                                         "\"result_age_ms\":" + std::to_string(status.resultAgeMs) + "}";
+                    conn.send_text(response);
+                }
                 // 处理相机内参标定文件下载请求
                 else if (action == "download_camera_calibration") {
                     std::cout << "📥 [DOWNLOAD] 接收到相机内参标定文件下载请求" << std::endl;
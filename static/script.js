@@ -424,8 +424,8 @@ class VideoStream {
         // 保留容器点击作为备用
         if (this.videoContainer) {
             this.videoContainer.addEventListener('click', (e) => {
-                // 如果点击的不是图像本身，则忽略
-                if (e.target !== this.videoElement) {
+                // 点击图像本身（包括分块合成画布）时已由图像的点击事件处理
+                if (e.target !== this.videoElement && e.target !== this.tileCanvas) {
                     this.handleVideoContainerClick(e);
                 }
             });
@@ -499,7 +499,7 @@ class VideoStream {
                 // If message is binary data (image frame)
                 if (event.data instanceof Blob) {
                     // 视频帧不记录日志，避免刷屏
-                    this.displayImageFrame(event.data);
+                    this.handleBinaryFrame(event.data);
                 } else if (typeof event.data === 'string') {
                     // Parse JSON message
                     try {
@@ -1843,6 +1843,137 @@ class VideoStream {
         this.toggleCameraCalibrationBtn.timeoutId = timeoutId;
     }
     
+    // 二进制帧分发：普通JPEG为完整帧（关键帧），以"TILE"开头的是分块更新
+    // 按到达顺序串行处理，保证块更新叠加在正确的画面上
+    handleBinaryFrame(blob) {
+        this.binaryFrameChain = (this.binaryFrameChain || Promise.resolve()).then(async () => {
+            const magic = new Uint8Array(await blob.slice(0, 4).arrayBuffer());
+            const isTileUpdate = magic.length === 4 &&
+                magic[0] === 0x54 && magic[1] === 0x49 && magic[2] === 0x4C && magic[3] === 0x45; // "TILE"
+            
+            if (isTileUpdate) {
+                await this.applyTileUpdate(blob);
+            } else {
+                this.lastKeyframeBlob = blob;
+                if (this.tileCanvas) {
+                    await this.drawKeyframeToCompositor(blob);
+                }
+                this.displayImageFrame(blob);
+            }
+        }).catch((error) => {
+            console.error('❌ [TILES] Error handling binary frame:', error);
+        }).then(() => {
+            this.sendFrameAck();
+        });
+    }
+    
+    // 每处理完一帧回复确认，服务器据此估计该连接的积压与延迟并选择质量档位
+    sendFrameAck() {
+        if (this.ws && this.ws.readyState === WebSocket.OPEN) {
+            this.ws.send('{"action":"frame_ack"}');
+        }
+    }
+    
+    // 把关键帧画到分块合成画布上，作为后续块更新的底图
+    // 画布放在 img 旁边，收到块更新后直接显示画布，不再重新编码成 JPEG 交给 img
+    async drawKeyframeToCompositor(blob) {
+        const bitmap = await createImageBitmap(blob);
+        if (!this.tileCanvas) {
+            this.tileCanvas = document.createElement('canvas');
+            this.tileCanvas.id = 'videoTiles';
+            this.tileContext = this.tileCanvas.getContext('2d');
+            if (this.video) {
+                this.tileCanvas.style.cssText = this.video.style.cssText;
+                this.tileCanvas.style.display = 'none';
+                this.tileCanvas.addEventListener('click', (e) => this.handleVideoImageClick(e));
+                this.video.insertAdjacentElement('afterend', this.tileCanvas);
+            }
+        }
+        if (this.tileCanvas.width !== bitmap.width || this.tileCanvas.height !== bitmap.height) {
+            this.tileCanvas.width = bitmap.width;
+            this.tileCanvas.height = bitmap.height;
+        }
+        this.tileContext.drawImage(bitmap, 0, 0);
+        bitmap.close();
+    }
+    
+    // 分块更新消息（小端）：
+    //   "TILE" | version u8 | flags u8 | tileCount u16 | sequence u32 | frameWidth u16 | frameHeight u16
+    //   每个块：x u16 | y u16 | width u16 | height u16 | jpegLength u32 | JPEG数据
+    async applyTileUpdate(blob) {
+        const buffer = await blob.arrayBuffer();
+        const view = new DataView(buffer);
+        const tileCount = view.getUint16(6, true);
+        const frameWidth = view.getUint16(12, true);
+        const frameHeight = view.getUint16(14, true);
+        
+        // 首次收到块更新时用最近的关键帧初始化画布
+        if (!this.tileCanvas) {
+            if (!this.lastKeyframeBlob) {
+                return; // 还没有底图，等待服务器发送关键帧
+            }
+            await this.drawKeyframeToCompositor(this.lastKeyframeBlob);
+        }
+        if (this.tileCanvas.width !== frameWidth || this.tileCanvas.height !== frameHeight) {
+            return; // 分辨率已变化，等待新的关键帧
+        }
+        
+        // 并行解码所有块，再按顺序绘制
+        const tiles = [];
+        let offset = 16;
+        for (let i = 0; i < tileCount; i++) {
+            const x = view.getUint16(offset, true);
+            const y = view.getUint16(offset + 2, true);
+            const length = view.getUint32(offset + 8, true);
+            const jpeg = new Blob([new Uint8Array(buffer, offset + 12, length)], { type: 'image/jpeg' });
+            tiles.push(createImageBitmap(jpeg).then((bitmap) => ({ x, y, bitmap })));
+            offset += 12 + length;
+        }
+        
+        for (const tile of await Promise.all(tiles)) {
+            this.tileContext.drawImage(tile.bitmap, tile.x, tile.y);
+            tile.bitmap.close();
+        }
+        
+        this.displayedFrameId = (this.displayedFrameId || 0) + 1;  // 之后才加载完成的旧关键帧不再切回 img
+        this.showTileCanvas(true);
+        this.updateFrameTiming();
+        if (this.resolutionElement) {
+            this.resolutionElement.textContent = `${this.tileCanvas.width}×${this.tileCanvas.height}`;
+        }
+    }
+    
+    // 块更新显示合成画布，关键帧显示 img（加载完成后再切换，避免闪烁）
+    showTileCanvas(visible) {
+        if (!this.tileCanvas || !this.video || !this.tileCanvas.parentNode) {
+            return;
+        }
+        this.tileCanvas.style.display = visible ? '' : 'none';
+        this.video.style.display = visible ? 'none' : '';
+    }
+    
+    // 每显示一帧更新帧计数和帧间隔显示
+    updateFrameTiming() {
+        this.frameCount++;
+        const now = performance.now();
+        this.latency = now - this.lastFrameTime;
+        this.lastFrameTime = now;
+        
+        if (this.latencyElement) {
+            this.latencyElement.textContent = `${Math.round(this.latency)} ms`;
+            
+            // 根据延迟给出颜色提示
+            if (this.latency > 200) {
+                this.latencyElement.style.color = '#dc3545'; // 红色：高延迟
+            } else if (this.latency > 100) {
+                this.latencyElement.style.color = '#ffc107'; // 黄色：中等延迟
+            } else {
+                this.latencyElement.style.color = '#28a745'; // 绿色：低延迟
+            }
+        }
+        return now;
+    }
+    
     // 修复：显示图像帧方法
     displayImageFrame(blob) {
         try {
@@ -1863,15 +1994,16 @@ class VideoStream {
             
             // Directly set to img element
             if (this.video) {
+                const frameId = this.displayedFrameId = (this.displayedFrameId || 0) + 1;
                 this.video.onload = () => {
                     // 性能监控：图像显示时间
                     const displayTime = performance.now();
                     
                     // Update frame count and time
-                    this.frameCount++;
-                    const now = performance.now();
-                    this.latency = now - this.lastFrameTime;
-                    this.lastFrameTime = now;
+                    if (frameId === this.displayedFrameId) {
+                        this.showTileCanvas(false);
+                    }
+                    const now = this.updateFrameTiming();
                     
                     // 性能分析
                     const urlCreateLatency = urlCreateTime - receiveTime;
@@ -1901,20 +2033,6 @@ class VideoStream {
                         this.performanceData.lastReport = now;
                     }
                     
-                    // Update latency display
-                    if (this.latencyElement) {
-                        this.latencyElement.textContent = `${Math.round(this.latency)} ms`;
-                        
-                        // 根据延迟给出颜色提示
-                        if (this.latency > 200) {
-                            this.latencyElement.style.color = '#dc3545'; // 红色：高延迟
-                        } else if (this.latency > 100) {
-                            this.latencyElement.style.color = '#ffc107'; // 黄色：中等延迟
-                        } else {
-                            this.latencyElement.style.color = '#28a745'; // 绿色：低延迟
-                        }
-                    }
-                    
                     // Update resolution display
                     if (this.resolutionElement && this.video.naturalWidth && this.video.naturalHeight) {
                         this.resolutionElement.textContent = `${this.video.naturalWidth}×${this.video.naturalHeight}`;
@@ -3187,11 +3305,12 @@ class VideoStream {
         const clickX = event.clientX - rect.left;
         const clickY = event.clientY - rect.top;
         
-        // 获取图像的显示尺寸和原始尺寸
+        // 获取图像的显示尺寸和原始尺寸（分块合成画布按画布分辨率换算）
         const displayWidth = imgElement.clientWidth;
         const displayHeight = imgElement.clientHeight;
-        const naturalWidth = imgElement.naturalWidth || displayWidth;
-        const naturalHeight = imgElement.naturalHeight || displayHeight;
+        const isCanvas = imgElement instanceof HTMLCanvasElement;
+        const naturalWidth = (isCanvas ? imgElement.width : imgElement.naturalWidth) || displayWidth;
+        const naturalHeight = (isCanvas ? imgElement.height : imgElement.naturalHeight) || displayHeight;
         
         // 计算缩放比例
         const scaleX = naturalWidth / displayWidth;